@@ -20,20 +20,87 @@
   -------------------------------------------------------------------------*/
 
 #include <NeoPixelEffects.h>
+#include <NeoPixelEffectsKernels.h>
+#include <NeoPixelEffectsParticles.h>
+
+// Longest gap, in milliseconds, the 16-bit end of a TALKING syllable can be
+// compared across. Syllables last under half a second.
+#define TALKING_HORIZON 30000
+
+// xorshift32: 32 random bits for three shifts, from one word of state
+static inline uint32_t nextRandom(uint32_t &state)
+{
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+#if !NEOPIXELEFFECTS_SEEDS
+// Generator every effect draws from when they have none of their own, one
+// per thread where effects may be rendered on several
+ #ifdef NEOPIXELEFFECTS_HAS_THREADS
+static thread_local uint32_t shared_random = 0x9E3779B9;
+ #else
+static uint32_t shared_random = 0x9E3779B9;
+ #endif
+#endif
+
+NeoPixelEffectsCache::NeoPixelEffectsCache(uint8_t *phase_table, int phase_count) :
+  phases(phase_table), phasecount(phase_count), keepphases(false), valid(false)
+{
+}
 
 NeoPixelEffects::NeoPixelEffects(CRGB *ledset, Effect effect, int pixstart, int pixend, int aoe, unsigned long delay, CRGB color_crgb, bool repeat, bool dir) :
-  _pixset(ledset), _color_fg(color_crgb), _color_bg(CRGB::Black), _repeat(repeat), _direction(dir), _counter(0)
+  NeoPixelEffects(ledset, pixstart, pixend, aoe, delay, color_crgb, repeat, dir)
 {
-  setRange(pixstart, pixend);
-  setAreaOfEffect(aoe);
-  setDelay(delay);
   setEffect(effect);
   // *assoc_effects = NULL;
 }
 
+// Sets everything but the effect, so no update() code is referenced from here
+NeoPixelEffects::NeoPixelEffects(CRGB *ledset, int pixstart, int pixend, int aoe, unsigned long delay, CRGB color_crgb, bool repeat, bool dir) :
+  _pixset(ledset), _lastupdate(0), _counter(0), _lateframes(0), _color_fg(color_crgb), _color_bg(CRGB::Black),
+  _effect(NONE), _status(INACTIVE), _timing(TIMING_SKIP), _repeat(repeat), _direction(dir), _startdirection(dir), _incremental(false), _scrollvalid(false)
+{
+#if NEOPIXELEFFECTS_COMPACT && !NEOPIXELEFFECTS_CACHE && !NEOPIXELEFFECTS_STATS && !NEOPIXELEFFECTS_POWER
+  // A compact effect with its default options: buffer and spark pool
+  // pointers, 32-bit clock, 4 bytes of effect state, the 32-bit generator,
+  // six 16-bit indices and the dirty span, 16-bit delay and late count,
+  // two colours and two bytes of effect and flags. That is 44 bytes on
+  // AVR, 48 on 32-bit boards and 56 on 64-bit hosts.
+  static_assert(sizeof(NeoPixelEffects) <= (sizeof(CRGB *) == 2 ? 44 : sizeof(CRGB *) == 4 ? 48 : 56),
+    "NeoPixelEffects no longer fits its compact size budget");
+#endif
+
+  setRange(pixstart, pixend);
+  setAreaOfEffect(aoe);
+  storeDelay(delay);
+  clearDirty();
+#if NEOPIXELEFFECTS_CACHE
+  _cache = NULL;
+#endif
+#if NEOPIXELEFFECTS_PARTICLES
+  _particles = NULL;
+#endif
+#if NEOPIXELEFFECTS_SEEDS
+  // Segments start from different seeds so they don't sparkle in step
+  setSeed(pixstart);
+#endif
+#if NEOPIXELEFFECTS_STATS
+  _stats.reset();
+#endif
+}
+
 NeoPixelEffects::NeoPixelEffects()
 {
-  *_pixset = NULL;
+  _pixset = NULL;
+#if NEOPIXELEFFECTS_CACHE
+  _cache = NULL;
+#endif
+#if NEOPIXELEFFECTS_PARTICLES
+  _particles = NULL;
+#endif
   _effect = NONE;
   _status = INACTIVE;
   _pixstart = 0;
@@ -42,134 +109,375 @@ NeoPixelEffects::NeoPixelEffects()
   _pixaoe = 1;
   _pixcurrent = _pixstart;
   _counter = 0;
+  clearDirty();
   _delay = 0;
   _lastupdate = 0;
+  _resync = true;
+  _timing = TIMING_SKIP;
+  _lateframes = 0;
+#if NEOPIXELEFFECTS_SEEDS
+  setSeed(0);
+#endif
+#if NEOPIXELEFFECTS_STATS
+  _stats.reset();
+#endif
+#if NEOPIXELEFFECTS_POWER
+  _load = 0;
+#endif
   _color_fg = CRGB::Black;
   _color_bg = CRGB::Black;
   _repeat = true;
   _direction = FORWARD;
+  _startdirection = FORWARD;
+  _incremental = false;
+  _scrollvalid = false;
 }
 
 NeoPixelEffects::~NeoPixelEffects()
 {
-  *_pixset = NULL;
+  _pixset = NULL;
 }
 
 void NeoPixelEffects::setEffect(Effect effect)
 {
   _effect = effect;
+  _startdirection = _direction;
   if (_direction == FORWARD) {
     _pixcurrent = _pixstart;
     _counter = 0;
   } else {
     _pixcurrent = _pixend;
     _counter = 100;
-    if (effect == TALKING) {
-      _counter = 0;
-    }
   }
-  _lastupdate = 0;
+  if (effect == TALKING) {
+    initTalkingEffect();
+  } else if (effect == FIREWORK || effect == SPARKLEFILL) {
+    initParticleEffect();
+  }
+  _resync = true;
   _status = ACTIVE;
 }
 
-void NeoPixelEffects::update()
+bool NeoPixelEffects::update()
+{
+  return update(millis());
+}
+
+bool NeoPixelEffects::update(unsigned long now)
+{
+  return runFrame(now, &NeoPixelEffects::stepAny);
+}
+
+void NeoPixelEffects::stepAny(NeoPixelEffects &effect)
+{
+  effect.stepEffect();
+}
+
+// Schedules, replays and renders one frame, drawing each tick with step.
+// Taking the step as a pointer lets NeoPixelEffectsCompiled share this
+// without pulling in the switch over every effect.
+bool NeoPixelEffects::runFrame(unsigned long now, StepFunction step)
+{
+  unsigned long missed;
+  if (!beginFrame(now, missed)) {
+    return false;
+  }
+#if NEOPIXELEFFECTS_STATS
+  unsigned long started = micros();
+#endif
+
+  if (missed > 0 && _timing == TIMING_CATCHUP) {
+    catchUp(missed, step);
+  }
+  // A replayed tick may have ended the effect
+  if (_status == ACTIVE && _effect != NONE) {
+    step(*this);
+  }
+
+#if NEOPIXELEFFECTS_STATS
+  recordFrame(now, missed, started);
+#endif
+  return true;
+}
+
+// Moves the schedule forward to now. Returns true if a frame is due, with
+// the number of ticks that were missed before it in missed.
+bool NeoPixelEffects::beginFrame(unsigned long now, unsigned long &missed)
 {
-  if (_status == ACTIVE) {
-    unsigned long now = millis();
-    if (now - _lastupdate > _delay) {
+#if NEOPIXELEFFECTS_STATS
+  _stats.calls++;
+#endif
+  missed = 0;
+  if (_status != ACTIVE || _effect == NONE) {
+    return false;
+  }
+
+  unsigned long elapsed = (millis_t)(now - _lastupdate);
+  if (_effect == TALKING && elapsed > TALKING_HORIZON) {
+    // Too long ago for the 16-bit syllable end, so the syllable is over
+    _state.talking.started = 0;
+  }
+
+  if (_resync) {
+    // First frame after a setter or resume starts a new timeline
+    _resync = false;
+    _scrollvalid = false;
+    deriveState();
+    _lastupdate = now;
+  } else {
+    if (elapsed < _delay) {
+      return false;
+    }
+
+    // Advance the schedule by whole periods so that late calls do not drift
+    if (_delay > 0) {
+      unsigned long periods = elapsed / _delay;
+      _lastupdate += periods * _delay;
+      missed = periods - 1;
+    } else {
       _lastupdate = now;
-      switch (_effect) {
-        case COMET:
-          updateCometEffect(0);
-          break;
-        case LARSON:
-          updateCometEffect(1);
-          break;
-        case CHASE:
-          updateChaseEffect();
-          break;
-        case PULSE:
-          updatePulseEffect();
-          break;
-        case STATIC:
-          updateStaticEffect(0);
-          break;
-        case RANDOM:
-          updateStaticEffect(1);
-          break;
-        case FADE:
-          updateFadeOutEffect();
-          break;
-        case FILLIN:
-          updateFillInEffect();
-          break;
-        case GLOW:
-          updateGlowEffect();
-          break;
-        case RAINBOWWAVE:
-          updateRainbowWaveEffect();
-          break;
-        case STROBE:
-          updateStrobeEffect();
-          break;
-        case SINEWAVE:
-          updateWaveEffect(0);
-          break;
-        case TRIWAVE:
-          updateWaveEffect(1);
-          break;
-        case TALKING:
-          updateTalkingEffect();
-          break;
-        // case FIREWORK:
-        //   updateFireworkEffect();
-        //   break;
-        // case SPARKLEFILL:
-        //   updateSparkleFillEffect();
-        //   break;
-        default:
-          break;
-      }
     }
+
+    if (talkingAtRest(_lastupdate)) {
+      return false;
+    }
+  }
+
+  // Ticks skipped while the mouth was closed were never due
+  if (missed > 0 && talkingClosed()) {
+    missed = 0;
   }
+  _lateframes += missed;
+  return true;
 }
 
-void NeoPixelEffects::updateCometEffect(int subtype)
+void NeoPixelEffects::catchUp(unsigned long steps, StepFunction step)
 {
-  if (subtype > 0) {
-    if (_repeat) _repeat = false;
+  if (steps > NEOPIXELEFFECTS_MAX_CATCHUP) {
+    steps = NEOPIXELEFFECTS_MAX_CATCHUP;
   }
 
-  for (int j = 0; j <= _pixaoe; j++) {
-    int tpx;
-    bool showpix = true;
-    if (_direction == FORWARD) {
-      tpx = _pixcurrent + j;
-      if (tpx > _pixend) {
-        if (_repeat) {
-          tpx = _pixcurrent + j - _pixrange + 1;
-        } else {
-          showpix = false;
+  // Replay the skipped ticks on the schedule they should have run at
+  unsigned long frametime = _lastupdate - steps * _delay;
+  for (unsigned long i = 0; i < steps && _status == ACTIVE && _effect != NONE; i++) {
+    millis_t scheduled = _lastupdate;
+    _lastupdate = frametime;
+    if (!advanceEffect()) {
+      step(*this);
+    }
+    _lastupdate = scheduled;
+    frametime += _delay;
+  }
+}
+
+void NeoPixelEffects::stepEffect()
+{
+  switch (_effect) {
+    case COMET:
+      updateCometEffect(0);
+      break;
+    case LARSON:
+      updateCometEffect(1);
+      break;
+    case CHASE:
+      updateChaseEffect();
+      break;
+    case PULSE:
+      updatePulseEffect();
+      break;
+    case STATIC:
+      updateStaticEffect(0);
+      break;
+    case RANDOM:
+      updateStaticEffect(1);
+      break;
+    case FADE:
+      updateFadeOutEffect();
+      break;
+    case FILLIN:
+      updateFillInEffect();
+      break;
+    case GLOW:
+      updateGlowEffect();
+      break;
+    case RAINBOWWAVE:
+      updateRainbowWaveEffect();
+      break;
+    case STROBE:
+      updateStrobeEffect();
+      break;
+    case SINEWAVE:
+      updateWaveEffect(0);
+      break;
+    case TRIWAVE:
+      updateWaveEffect(1);
+      break;
+    case TALKING:
+      updateTalkingEffect();
+      break;
+    case FIREWORK:
+      updateFireworkEffect();
+      break;
+    case SPARKLEFILL:
+      updateSparkleFillEffect();
+      break;
+    default:
+      break;
+  }
+}
+
+// Renders the frame the effect shows the given number of ticks after it was
+// started, without stepping through the frames in between or touching the
+// effect's state. Returns false for effects whose frames depend on random
+// numbers or on the previous frame (STATIC, RANDOM, FADE, TALKING).
+bool NeoPixelEffects::render(unsigned long tick)
+{
+  bool forward = (_startdirection == FORWARD);
+  int counter = forward ? 0 : 100;
+  _scrollvalid = false;
+  deriveState();
+
+  switch (_effect) {
+    case COMET:
+      if (_repeat) {
+        int offset = tick % _pixrange;
+        clear();
+        drawComet(forward ? _pixstart + offset : _pixend - offset, _startdirection, true);
+      } else {
+        // A one-shot comet stops and clears itself after its last pixel
+        clear();
+        if (tick < (unsigned long)_pixrange - 1) {
+          drawComet(forward ? _pixstart + tick : _pixend - tick, _startdirection, false);
         }
       }
-    } else {
-      tpx = _pixcurrent - j;
-      if (tpx < _pixstart) {
-        if (_repeat) {
-          tpx = _pixcurrent - j + _pixrange;
+      return true;
+    case LARSON:
+      {
+        // Each pass holds the end pixel for one extra tick while turning around
+        unsigned long lap = tick % (2UL * _pixrange);
+        bool outward = lap < (unsigned long)_pixrange;
+        int offset = outward ? lap : lap - _pixrange;
+        bool direction = (outward == forward) ? FORWARD : REVERSE;
+        clear();
+        drawComet(direction == FORWARD ? _pixstart + offset : _pixend - offset, direction, false);
+      }
+      return true;
+    case CHASE:
+      drawChase(tick % 2);
+      return true;
+    case STROBE:
+      drawStrobe(tick % 2);
+      return true;
+    case PULSE:
+    case GLOW:
+      {
+        // The counter bounces 0..100..0 with a period of 200 ticks
+        unsigned long bounce = counter + tick;
+        if (_effect == GLOW && !_repeat && bounce > 199) {
+          bounce = 199;
+        }
+        bounce %= 200;
+        int level = (bounce <= 100) ? bounce : 200 - bounce;
+        if (_effect == GLOW) {
+          drawGlow(level);
         } else {
-          showpix = false;
+          drawPulse(level);
         }
       }
-    }
+      return true;
+    case RAINBOWWAVE:
+      drawRainbowWave(forward ? counter + tick : counter - tick);
+      return true;
+    case SINEWAVE:
+    case TRIWAVE:
+      // Only the low 8 bits of the wave counter affect the phase
+      drawWave((uint8_t)(forward ? counter + 2 * tick : counter - 2 * tick), _effect == TRIWAVE);
+      return true;
+    case FILLIN:
+      {
+        unsigned long filled = (tick < (unsigned long)_pixrange) ? tick + 1 : _pixrange;
+        markDirty(_pixstart, _pixend);
+        for (int i = 0; i < _pixrange; i++) {
+          int pix = forward ? _pixstart + i : _pixend - i;
+          _pixset[pix] = (i < (int)filled) ? _color_fg : _color_bg;
+        }
+        setLoad(_color_fg, filled, _color_bg);
+      }
+      return true;
+    default:
+      return false;
+  }
+}
 
-    if (showpix) {
-      float ratio = j / (float)_pixaoe;
-      CRGB tailcolor = CRGB(_color_fg.r * ratio, _color_fg.g * ratio, _color_fg.b * ratio);
+// Advances effects whose frames depend only on their counters without
+// rendering. Returns false for effects that must be rendered to advance.
+bool NeoPixelEffects::advanceEffect()
+{
+  // The buffer no longer holds the frame before the next one
+  _scrollvalid = false;
 
-      _pixset[tpx] = tailcolor;
+  switch (_effect) {
+    case CHASE:
+    case STROBE:
+      _counter++;
+      return true;
+    case PULSE:
+      advanceBounce();
+      return true;
+    case GLOW:
+      // A one-shot glow renders its last frame before pausing
+      if (!_repeat && _direction == REVERSE && _counter <= 1) {
+        return false;
+      }
+      advanceBounce();
+      return true;
+    case RAINBOWWAVE:
+      _counter = (_direction) ? _counter + 1 : _counter - 1;
+      return true;
+    case SINEWAVE:
+    case TRIWAVE:
+      _counter = (_direction) ? _counter + 2 : _counter - 2;
+      return true;
+    case STATIC:
+    case RANDOM:
+      {
+        // Draw the words the frame would have used, one per four pixels of
+        // STATIC or four channel bytes of RANDOM, so later frames match
+        long bytes = (_effect == STATIC) ? _pixrange : (long)_pixrange * sizeof(CRGB);
+        uint32_t &state = randomState();
+        for (long words = (bytes + 3) / 4; words > 0; words--) {
+          nextRandom(state);
+        }
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Steps _counter up to 100 and back down, returns true when it reaches 0
+bool NeoPixelEffects::advanceBounce()
+{
+  if (_direction == FORWARD) {
+    _counter++;
+    if (_counter >= 100) _direction = REVERSE;
+  } else {
+    _counter--;
+    if (_counter <= 0) {
+      _direction = FORWARD;
+      return true;
     }
   }
+  return false;
+}
+
+void NeoPixelEffects::updateCometEffect(int subtype)
+{
+  if (subtype > 0) {
+    if (_repeat) _repeat = false;
+  }
+
+  drawComet(_pixcurrent, _direction, _repeat);
 
   if (_direction == FORWARD) {
     if (_pixcurrent == _pixend) {
@@ -202,10 +510,83 @@ void NeoPixelEffects::updateCometEffect(int subtype)
   }
 }
 
+void NeoPixelEffects::drawComet(int current, bool direction, bool repeat)
+{
+#if NEOPIXELEFFECTS_FIXED_POINT
+  // Tail brightness j / _pixaoe as a 16.16 accumulator stepped once per pixel
+  uint32_t tailstep = _state.comet.tailstep;
+  uint32_t tailscale = 0;
+#endif
+  int first = _pixend;
+  int last = _pixstart;
+
+  for (int j = 0; j <= _pixaoe; j++) {
+    int tpx;
+    bool showpix = true;
+    if (direction == FORWARD) {
+      tpx = current + j;
+      if (tpx > _pixend) {
+        if (repeat) {
+          tpx = current + j - _pixrange + 1;
+        } else {
+          showpix = false;
+        }
+      }
+    } else {
+      tpx = current - j;
+      if (tpx < _pixstart) {
+        if (repeat) {
+          tpx = current - j + _pixrange;
+        } else {
+          showpix = false;
+        }
+      }
+    }
+
+    if (showpix) {
+#if NEOPIXELEFFECTS_FIXED_POINT
+      CRGB tailcolor = _color_fg;
+      tailcolor.nscale8(tailscale >> 16);
+#else
+      float ratio = j / (float)_pixaoe;
+      CRGB tailcolor = CRGB(_color_fg.r * ratio, _color_fg.g * ratio, _color_fg.b * ratio);
+#endif
+
+      trackPixel(_pixset[tpx], tailcolor);
+      _pixset[tpx] = tailcolor;
+      first = min(first, tpx);
+      last = max(last, tpx);
+    }
+#if NEOPIXELEFFECTS_FIXED_POINT
+    tailscale += tailstep;
+#endif
+  }
+  if (first <= last) {
+    markDirty(first, last);
+  }
+}
+
 void NeoPixelEffects::updateChaseEffect()
 {
+  // Each frame is the last one moved one pixel towards the start
+  if (_scrollvalid && _pixrange > 1) {
+    CRGB leaving = _pixset[_pixstart];
+    shiftPixels(_pixset + _pixstart, _pixrange, true);
+    _pixset[_pixend] = ((_counter & 1) == (_pixend & 1)) ? _color_fg : _color_bg;
+    trackPixel(leaving, _pixset[_pixend]);
+    markDirty(_pixstart, _pixend);
+  } else {
+    drawChase(_counter);
+  }
+  _counter++;
+  _scrollvalid = _incremental;
+}
+
+void NeoPixelEffects::drawChase(int counter)
+{
+  markDirty(_pixstart, _pixend);
   for (int j = _pixstart; j <= _pixend; j++) {
-    if (_counter % 2 == 0) {
+    if (counter % 2 == 0) {
       if (j % 2 == 0) {
         _pixset[j] = _color_fg;
       } else {
@@ -219,54 +600,107 @@ void NeoPixelEffects::updateChaseEffect()
       }
     }
   }
-  _counter++;
+  // Even pixels show the foreground on even counters
+  int evens = (_pixend >> 1) - ((_pixstart + 1) >> 1) + 1;
+  setLoad(_color_fg, (counter % 2 == 0) ? evens : _pixrange - evens, _color_bg);
 }
 
 void NeoPixelEffects::updateStrobeEffect()
+{
+  drawStrobe(_counter);
+  _counter++;
+}
+
+void NeoPixelEffects::drawStrobe(int counter)
 {
   CRGB strobecolor;
-  if (_counter % 2 == 0) {
+  if (counter % 2 == 0) {
     strobecolor = _color_fg;
   } else {
     strobecolor = _color_bg;
   }
 
-  for (int j = _pixstart; j <= _pixend; j++) {
-    _pixset[j] = strobecolor;
-  }
-  _counter++;
+  fillPixels(_pixset + _pixstart, _pixrange, strobecolor);
+  setLoad(strobecolor);
+  markDirty(_pixstart, _pixend);
 }
 
 void NeoPixelEffects::updateStaticEffect(int subtype)
 {
-  random16_add_entropy(random(65535));
+  markDirty(_pixstart, _pixend);
 
-  for (int i = _pixstart; i <= _pixend; i++) {
-    CRGB randomcolor;
-    if (subtype == 0) {
-      float random_ratio = random8(101) / 100.0;
-      randomcolor.r = _color_fg.r * random_ratio;
-      randomcolor.g = _color_fg.g * random_ratio;
-      randomcolor.b = _color_fg.b * random_ratio;
-    } else {
-      randomcolor.r = 255 * random8(101) / 100.0;
-      randomcolor.g = 255 * random8(101) / 100.0;
-      randomcolor.b = 255 * random8(101) / 100.0;
+  // Random bits are drawn a word at a time from a local copy of the state
+  uint32_t state = randomState();
+  CRGB *pix = _pixset + _pixstart;
+
+  uint32_t load = 0;
+  if (subtype == 0) {
+    // One brightness byte per pixel, four pixels per word
+    uint32_t bits = 0;
+    for (int i = 0; i < _pixrange; i++) {
+      if ((i & 3) == 0) {
+        bits = nextRandom(state);
+      }
+      uint8_t value = bits;
+      bits >>= 8;
+#if NEOPIXELEFFECTS_FIXED_POINT
+      pix[i] = _color_fg;
+      pix[i].nscale8(value);
+#else
+      float random_ratio = value / 255.0;
+      pix[i].r = _color_fg.r * random_ratio;
+      pix[i].g = _color_fg.g * random_ratio;
+      pix[i].b = _color_fg.b * random_ratio;
+#endif
+      load += pixelLoad(pix[i]);
+    }
+  } else {
+    // Every channel byte is random, so fill the range straight from the generator
+    uint8_t *bytes = (uint8_t *)pix;
+    int count = _pixrange * sizeof(CRGB);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      uint32_t bits = nextRandom(state);
+      memcpy(bytes + i, &bits, 4);
+      load += byteSum(bits);
+    }
+    if (i < count) {
+      uint32_t bits = nextRandom(state);
+      memcpy(bytes + i, &bits, count - i);
+      for (; i < count; i++) {
+        load += bytes[i];
+      }
     }
-    _pixset[i] = randomcolor;
   }
+
+  randomState() = state;
+  storeLoad(load);
 }
 
 void NeoPixelEffects::updateFadeOutEffect()
 {
   if (_counter == 0) _counter = 100;
-  float ratio = _counter / 100.0;
 
   CRGB fadecolor;
+#if NEOPIXELEFFECTS_FIXED_POINT
+  // A fraction of 65536 (100%) leaves the pixels unchanged
+  uint32_t fraction = percentToFraction(_counter);
+  if (fraction < 65536) {
+    storeLoad(scalePixels(_pixset + _pixstart, _pixrange, fraction));
+    markDirty(_pixstart, _pixend);
+  }
+  fadecolor = _pixset[_pixend];
+#else
+  float ratio = _counter / 100.0;
+  uint32_t load = 0;
   for (int i = _pixstart; i <= _pixend; i++) {
     fadecolor = CRGB(_pixset[i].r * ratio, _pixset[i].g * ratio, _pixset[i].b * ratio);
     _pixset[i] = fadecolor;
+    load += pixelLoad(fadecolor);
   }
+  storeLoad(load);
+  markDirty(_pixstart, _pixend);
+#endif
 
   _counter--;
 
@@ -277,7 +711,9 @@ void NeoPixelEffects::updateFadeOutEffect()
 
 void NeoPixelEffects::updateFillInEffect()
 {
+  trackPixel(_pixset[_pixcurrent], _color_fg);
   _pixset[_pixcurrent] = _color_fg;
+  markDirty(_pixcurrent, _pixcurrent);
   if (_direction == FORWARD) {
     if (_pixcurrent != _pixend) {
       _pixcurrent++;
@@ -295,146 +731,460 @@ void NeoPixelEffects::updateFillInEffect()
 
 void NeoPixelEffects::updateGlowEffect()
 {
-  // Ensure glow_area_half is always even
-  if (_pixrange % 2 == 0 && _pixaoe % 2 != 0) {
-    _pixaoe++;
-  } else if (_pixrange % 2 != 0 && _pixaoe % 2 == 0) {
-    _pixaoe--;
+  int counter = _counter;
+  if (advanceBounce() && !_repeat) {
+    pause();
   }
+  drawGlow(counter);
+}
+
+void NeoPixelEffects::drawGlow(int counter)
+{
+  int aoe = _state.glow.aoe;
 
-  float ratio = _counter / 100.0;
   CRGB glowcolor;
+#if NEOPIXELEFFECTS_FIXED_POINT
+  glowcolor = _color_fg;
+  scaleColor(glowcolor, percentToFraction(counter));
+#else
+  float ratio = counter / 100.0;
   glowcolor.r = _color_fg.r * ratio;
   glowcolor.g = _color_fg.g * ratio;
   glowcolor.b = _color_fg.b * ratio;
+#endif
 
-  if (_direction == FORWARD) {
-    _counter++;
-    if (_counter >= 100) _direction = REVERSE;
-  } else {
-    _counter--;
-    if (_counter <= 0) {
-      _direction = FORWARD;
-      if (!_repeat) {
-        pause();
-      }
-    }
-  }
-
-  int glow_area_half = (_pixrange - _pixaoe) / 2;
+  int glow_area_half = _state.glow.half;
+  uint32_t load = 0;
   for (int i = 0; i < glow_area_half ; i++) {
-    uint8_t denom = glow_area_half + 1 - i;
+    int denom = glow_area_half + 1 - i;
     CRGB tempcolor = CRGB(glowcolor.r / denom, glowcolor.g / denom, glowcolor.b / denom);
     _pixset[_pixstart + i] = tempcolor;
     _pixset[_pixend - i] = tempcolor;
+    // The two ends meet in the middle when aoe rounds down to nothing
+    load += pixelLoad(tempcolor) * ((_pixstart + i == _pixend - i) ? 1 : 2);
   }
-  for (int i = 0; i < _pixaoe; i++) {
+  for (int i = 0; i < aoe; i++) {
     _pixset[_pixstart + glow_area_half + i] = glowcolor;
   }
+  storeLoad(load + (uint32_t)max(aoe, 0) * pixelLoad(glowcolor));
+  markDirty(_pixstart, _pixend);
 }
 
 void NeoPixelEffects::updatePulseEffect()
+{
+  drawPulse(_counter);
+  advanceBounce();
+}
+
+void NeoPixelEffects::drawPulse(int counter)
 {
   CRGB pulsecolor;
 
-  float ratio = _counter / 100.0;
+#if NEOPIXELEFFECTS_FIXED_POINT
+  pulsecolor = _color_fg;
+  scaleColor(pulsecolor, percentToFraction(counter));
+#else
+  float ratio = counter / 100.0;
   pulsecolor.r = _color_fg.r * ratio;
   pulsecolor.g = _color_fg.g * ratio;
   pulsecolor.b = _color_fg.b * ratio;
+#endif
 
-  if (_direction == FORWARD) {
-    _counter++;
-    if (_counter >= 100) _direction = REVERSE;
-  } else {
-    _counter--;
-    if (_counter <= 0) _direction = FORWARD;
+  fillPixels(_pixset + _pixstart, _pixrange, pulsecolor);
+  setLoad(pulsecolor);
+  markDirty(_pixstart, _pixend);
+}
+
+// Stages of FIREWORK and SPARKLEFILL
+enum ParticlePhase {
+  PARTICLES_RISE,     // The mortar climbs, or the fill grows
+  PARTICLES_BURN,     // Sparks burn out
+  PARTICLES_REST      // Dark pause before the next shot
+};
+
+// Firework tuning, in 1/256 pixel and frames
+#define FIREWORK_GRAVITY  -2  // Pulls the stars back towards the launch end
+#define FIREWORK_DRAG     20  // Share of star velocity lost per frame, so stars travel about aoe pixels
+#define FIREWORK_REST     12  // Dark frames between shots
+
+void NeoPixelEffects::initParticleEffect()
+{
+  _counter = 0;
+  _state.particles.phase = PARTICLES_RISE;
+  _state.particles.wait = 0;
+  NeoPixelEffectsParticles *pool = particlePool();
+  if (pool != NULL) {
+    pool->clear();
   }
+}
 
-  for (int i = _pixstart; i <= _pixend; i++) {
-    _pixset[i] = pulsecolor;
+// A mortar climbs from the start of the range (the end if REVERSE) to aoe
+// pixels short of the far end and bursts into stars that spread about aoe
+// pixels, slow down, sink and burn out
+void NeoPixelEffects::updateFireworkEffect()
+{
+  uint8_t &phase = _state.particles.phase;
+  bool reverse = (_direction == REVERSE);
+  int apex = max(_pixrange - 1 - _pixaoe, 0);
+  NeoPixelEffectsParticles *pool = particlePool();
+
+  fillPixels(_pixset + _pixstart, _pixrange, _color_bg);
+  setLoad(_color_bg);
+  markDirty(_pixstart, _pixend);
+  if (pool != NULL) {
+    pool->step(FIREWORK_GRAVITY, FIREWORK_DRAG, _pixrange);
+  }
+
+  switch (phase) {
+    case PARTICLES_RISE:
+      // White head with a short tail, as the original mortar comet
+      for (int i = 0; i < 3 && _counter - i >= 0; i++) {
+        CRGB shell = CRGB::White;
+        shell.nscale8(i == 0 ? 255 : (i == 1 ? 96 : 32));
+        int pix = _counter - i;
+        CRGB &target = _pixset[reverse ? _pixend - pix : _pixstart + pix];
+        trackPixel(target, shell);
+        target = shell;
+      }
+      if (_counter < apex) {
+        _counter++;
+        break;
+      }
+      if (pool != NULL) {
+        int spread = min(_pixaoe * FIREWORK_DRAG, 32767);
+        for (int i = 0; i < 2 * _pixaoe; i++) {
+          uint32_t bits = nextRandom(randomState());
+          int velocity = (int)(((bits & 0xFFFF) * (uint32_t)(2 * spread + 1)) >> 16) - spread;
+          if (!pool->spawn(((long)apex << 8) + 128, velocity, _color_fg, 4 + ((bits >> 16) & 7))) {
+            break;
+          }
+        }
+      }
+      phase = PARTICLES_BURN;
+      break;
+    case PARTICLES_BURN:
+      if (pool == NULL || pool->getCount() == 0) {
+        _state.particles.wait = FIREWORK_REST;
+        phase = PARTICLES_REST;
+      }
+      break;
+    default:
+      if (_state.particles.wait > 0) {
+        _state.particles.wait--;
+      } else if (_repeat) {
+        _counter = 0;
+        phase = PARTICLES_RISE;
+      } else {
+        pause();
+      }
+      break;
+  }
+
+  if (pool != NULL) {
+    addLoad(pool->render(_pixset + _pixstart, _pixrange, reverse));
   }
 }
 
-// void NeoPixelEffects::updateFireworkEffect()
-// {
-//   static NeoPixelEffects *m = new NeoPixelEffects(_pixset, COMET, _pixstart,                  _pixend - _pixaoe - 4, 2,         25,     CRGB::White,  false, FORWARD);
-//   static NeoPixelEffects *s1 = new NeoPixelEffects(_pixset, NONE, _pixend - 2 * _pixaoe - 4,  _pixend - _pixaoe - 2, stars_aoe, _delay, _color_fg, false, REVERSE);
-//   static NeoPixelEffects *s2 = new NeoPixelEffects(_pixset, NONE, _pixend - _pixaoe - 2,      stars_end,             stars_aoe, _delay, _color_fg, false, FORWARD);
-//   static NeoPixelEffects *sf = new NeoPixelEffects(_pixset, NONE, _pixend - 2 * _pixaoe - 4,  _pixend,               1,         7,      _color_fg, false, REVERSE);
-//
-//   if (_counter == 0 && m->getEffect() == NONE) {
-//     delay(200);
-//     s1->setEffect(FILLIN);
-//     s2->setEffect(FILLIN);
-//     _counter = 1;
-//   } else if (_counter == 1 && s1->getEffect() == NONE && s2->getEffect() == NONE) {
-//     delay(200);
-//     sf->setEffect(FADE);
-//     _counter = 2;
-//   } else if (_counter == 2 && sf->getEffect() == NONE) {
-//     delete(m);
-//     delete(s1);
-//     delete(s2);
-//     delete(sf);
-//     setEffect(NONE);
-//   }
-//
-//   m->update();
-//   s1->update();
-//   s2->update();
-//   sf->update();
-// }
+// The range fills from one end one pixel per frame with aoe short-lived
+// sparks lit at random in the filled part each frame. Looping effects keep
+// sparkling once full; one-shot effects let the last sparks burn out and
+// pause.
+void NeoPixelEffects::updateSparkleFillEffect()
+{
+  uint8_t &phase = _state.particles.phase;
+  NeoPixelEffectsParticles *pool = particlePool();
 
-// void NeoPixelEffects::updateSparkleFillEffect()
-// {
-//   static NeoPixelEffects *sparkles = new NeoPixelEffects(_pixset, STATIC, (_direction==FORWARD)?_pixstart,  (_direction==FORWARD)?_pixstart:_pixend, 1, _delay, _color_fg, false, _direction);
-//
-//   sparkles->update();
-//
-//   if (_direction == FORWARD) {
-//     if (_pixcurrent != _pixend) {
-//       _pixcurrent++;
-//       sparkles->setRange(_pixstart, _pixcurrent);
-//     }
-//   } else {
-//     if (_pixcurrent != _pixstart) {
-//       _pixcurrent--;
-//       sparkles->setRange(_pixcurrent, _pixend);
-//     }
-//   }
-//
-//   if (_status == INACTIVE) {
-//     delete(sparkles);
-//     clear();
-//     setEffect(NONE);
-//   }
-// }
+  fillPixels(_pixset + _pixstart, _pixrange, _color_bg);
+  setLoad(_color_bg);
+  markDirty(_pixstart, _pixend);
+
+  if (pool != NULL) {
+    pool->step(0, 0, _pixrange);
+    if (phase == PARTICLES_RISE || _repeat) {
+      // Random position in the filled part, in 1/256 pixel
+      uint32_t filled = _counter + 1;
+      for (int i = 0; i < _pixaoe; i++) {
+        uint32_t bits = nextRandom(randomState());
+        long position = ((bits & 0xFFFF) * filled) >> 8;
+        if (!pool->spawn(position, 0, _color_fg, 12 + ((bits >> 16) & 31))) {
+          break;
+        }
+      }
+    }
+    addLoad(pool->render(_pixset + _pixstart, _pixrange, _direction == REVERSE));
+  }
+
+  if (phase == PARTICLES_RISE) {
+    if (_counter < _pixrange - 1) {
+      _counter++;
+    } else {
+      phase = PARTICLES_BURN;
+    }
+  } else if (!_repeat && (pool == NULL || pool->getCount() == 0)) {
+    pause();
+  }
+}
 
 void NeoPixelEffects::updateRainbowWaveEffect()
 {
+  // Pixel i shows hue (counter + i), so each frame is the last one moved
+  // one pixel against the direction with a single new pixel at the end
+  if (_scrollvalid && _pixrange > 1 && !usePhases()) {
+    CRGB leaving = (_direction == FORWARD) ? _pixset[_pixstart] : _pixset[_pixend];
+    shiftPixels(_pixset + _pixstart, _pixrange, _direction == FORWARD);
+    if (_direction == FORWARD) {
+      _pixset[_pixend] = rainbowColor(_counter + _pixend);
+      trackPixel(leaving, _pixset[_pixend]);
+    } else {
+      _pixset[_pixstart] = rainbowColor(_counter + _pixstart);
+      trackPixel(leaving, _pixset[_pixstart]);
+    }
+    markDirty(_pixstart, _pixend);
+  } else {
+    drawRainbowWave(_counter);
+  }
+  int next = (_direction) ? _counter + 1 : _counter - 1;
+  _counter = next;
+  // A compact counter that wrapped no longer continues the last frame
+  _scrollvalid = _incremental && _counter == next;
+}
+
+CRGB NeoPixelEffects::rainbowColor(long position)
+{
+#if NEOPIXELEFFECTS_FIXED_POINT
+  long numer = position * 255;
+  long quot = numer / _pixrange;
+  if (numer % _pixrange < 0) {
+    quot--;
+  }
+  return CHSV((uint8_t)quot, 255, 255);
+#else
+  float ratio = 255.0  / _pixrange;
+  return CHSV((uint8_t)((int)position * ratio), 255, 255);
+#endif
+}
+
+void NeoPixelEffects::drawRainbowWave(int counter)
+{
+  markDirty(_pixstart, _pixend);
+#if NEOPIXELEFFECTS_CACHE
+  if (usePhases()) {
+    // Each pixel's hue is its own phase, moved one range per cycle
+    long numer = (long)counter * 255;
+    long quot = numer / _pixrange;
+    if (numer % _pixrange < 0) {
+      quot--;
+    }
+    uint8_t offset = quot;
+    const CRGB *ramp = _cache->ramp;
+    const uint8_t *phases = _cache->phases;
+    uint32_t load = 0;
+    for (int i = 0; i < _pixrange; i++) {
+      _pixset[_pixstart + i] = ramp[(uint8_t)(phases[i] + offset)];
+      load += pixelLoad(_pixset[_pixstart + i]);
+    }
+    storeLoad(load);
+    return;
+  }
+#endif
+#if NEOPIXELEFFECTS_FIXED_POINT
+  // Hue is (counter + i) * 255 / _pixrange; start from the first pixel's
+  // quotient and remainder and step them without dividing per pixel
+  long numer = (long)(counter + _pixstart) * 255;
+  long quot = numer / _pixrange;
+  int rem = numer % _pixrange;
+  if (rem < 0) {
+    rem += _pixrange;
+    quot--;
+  }
+  uint8_t hue = quot;
+  uint8_t hue_step = 255 / _pixrange;
+  int rem_step = 255 % _pixrange;
+
+  const CRGB *ramp = cacheRamp();
+  uint32_t load = 0;
+  for (int i = _pixstart; i <= _pixend; i++) {
+    if (ramp != NULL) {
+      _pixset[i] = ramp[hue];
+    } else {
+      _pixset[i] = CHSV(hue, 255, 255);
+    }
+    load += pixelLoad(_pixset[i]);
+    hue += hue_step;
+    rem += rem_step;
+    if (rem >= _pixrange) {
+      rem -= _pixrange;
+      hue++;
+    }
+  }
+#else
   float ratio = 255.0  / _pixrange;
+  const CRGB *ramp = cacheRamp();
+  uint32_t load = 0;
 
   for (int i = _pixstart; i <= _pixend; i++) {
-    CRGB color = CHSV((uint8_t)((_counter + i) * ratio), 255, 255);
+    uint8_t hue = (counter + i) * ratio;
+    CRGB color = (ramp != NULL) ? ramp[hue] : CRGB(CHSV(hue, 255, 255));
     _pixset[i] = color;
+    load += pixelLoad(color);
+  }
+#endif
+  storeLoad(load);
+}
+
+// Returns true if the rainbow should follow a phase table the sketch filled
+// instead of running along the range
+bool NeoPixelEffects::usePhases()
+{
+#if NEOPIXELEFFECTS_CACHE
+  return _cache != NULL && _cache->keepphases && _cache->phases != NULL &&
+         _cache->phasecount >= _pixrange && useCache();
+#else
+  return false;
+#endif
+}
+
+// Rebuilds the per-effect values that only change with the settings
+void NeoPixelEffects::deriveState()
+{
+  switch (_effect) {
+    case COMET:
+    case LARSON:
+      _state.comet.tailstep = ((uint32_t)255 << 16) / _pixaoe;
+      break;
+    case GLOW:
+      {
+        // Ensure glow_area_half is always even
+        int aoe = _pixaoe;
+        if (_pixrange % 2 == 0 && aoe % 2 != 0) {
+          aoe++;
+        } else if (_pixrange % 2 != 0 && aoe % 2 == 0) {
+          aoe--;
+        }
+        _state.glow.aoe = aoe;
+        _state.glow.half = (_pixrange - aoe) / 2;
+      }
+      break;
+    default:
+      break;
   }
-  _counter = (_direction) ? _counter + 1 : _counter - 1;
+}
+
+// Returns true if the cache holds tables for the current settings,
+// rebuilding them first if the effect, colour or range changed
+bool NeoPixelEffects::useCache()
+{
+#if NEOPIXELEFFECTS_CACHE
+  if (_cache == NULL) {
+    return false;
+  }
+  if (_cache->valid && _cache->effect == _effect && _cache->color == _color_fg &&
+      _cache->pixstart == _pixstart && _cache->pixrange == _pixrange) {
+    return true;
+  }
+
+  CRGB *ramp = _cache->ramp;
+  for (int p = 0; p < 256; p++) {
+    if (_effect == RAINBOWWAVE) {
+      ramp[p] = CHSV(p, 255, 255);
+    } else {
+      uint8_t level = (_effect == TRIWAVE) ? triwave8(p) : cubicwave8(p);
+#if NEOPIXELEFFECTS_FIXED_POINT
+      ramp[p] = _color_fg;
+      ramp[p].nscale8(level);
+#else
+      float ratio = level / 255.0;
+      ramp[p] = CRGB(_color_fg.r * ratio, _color_fg.g * ratio, _color_fg.b * ratio);
+#endif
+    }
+  }
+  if (_cache->phases != NULL && _cache->phasecount >= _pixrange && !_cache->keepphases) {
+    for (int i = 0; i < _pixrange; i++) {
+      _cache->phases[i] = 255L * i / _pixrange;
+    }
+  }
+
+  _cache->effect = (Effect)_effect;
+  _cache->color = _color_fg;
+  _cache->pixstart = _pixstart;
+  _cache->pixrange = _pixrange;
+  _cache->valid = true;
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Colour table to draw from, or NULL to calculate each pixel
+const CRGB *NeoPixelEffects::cacheRamp()
+{
+#if NEOPIXELEFFECTS_CACHE
+  if (useCache()) {
+    return _cache->ramp;
+  }
+#endif
+  return NULL;
+}
+
+// Spark pool to draw from, or NULL to draw no sparks
+NeoPixelEffectsParticles *NeoPixelEffects::particlePool()
+{
+#if NEOPIXELEFFECTS_PARTICLES
+  return _particles;
+#else
+  return NULL;
+#endif
 }
 
 void NeoPixelEffects::updateWaveEffect(int subtype)
 {
+  drawWave(_counter, subtype);
+  _counter = (_direction) ? _counter + 2 : _counter - 2;
+}
+
+void NeoPixelEffects::drawWave(int counter, int subtype)
+{
+  uint32_t load = 0;
+  markDirty(_pixstart, _pixend);
+#if NEOPIXELEFFECTS_CACHE
+  if (useCache()) {
+    const CRGB *ramp = _cache->ramp;
+    if (_cache->phases != NULL && _cache->phasecount >= _pixrange) {
+      const uint8_t *phases = _cache->phases;
+      for (int i = 0; i < _pixrange; i++) {
+        _pixset[_pixstart + i] = ramp[(uint8_t)(phases[i] + counter)];
+        load += pixelLoad(_pixset[_pixstart + i]);
+      }
+    } else {
+      for (int i = _pixstart; i <= _pixend; i++) {
+        _pixset[i] = ramp[(uint8_t)((255L * (i - _pixstart) / _pixrange) + counter)];
+        load += pixelLoad(_pixset[i]);
+      }
+    }
+    storeLoad(load);
+    return;
+  }
+#endif
+
   for (int i = _pixstart; i <= _pixend; i++) {
+    uint8_t phase = (255L * (i - _pixstart) / _pixrange) + counter;
+#if NEOPIXELEFFECTS_FIXED_POINT
+    CRGB wavecolor = _color_fg;
+    wavecolor.nscale8((!subtype) ? cubicwave8(phase) : triwave8(phase));
+#else
     float ratio;
     if (!subtype) {
-      ratio = cubicwave8((255 * (i - _pixstart) / _pixrange) + _counter) / 255.0;
+      ratio = cubicwave8(phase) / 255.0;
     } else {
-      ratio = triwave8((255 * (i - _pixstart) / _pixrange) + _counter) / 255.0;
+      ratio = triwave8(phase) / 255.0;
     }
 
     CRGB wavecolor = CRGB(_color_fg.r * ratio, _color_fg.g * ratio, _color_fg.b * ratio);
+#endif
     _pixset[i] = wavecolor;
+    load += pixelLoad(wavecolor);
   }
-  _counter = (_direction) ? _counter + 2 : _counter - 2;
+  storeLoad(load);
 }
 
 // void NeoPixelEffects::updateTalkingEffectV2()
@@ -506,27 +1256,31 @@ void NeoPixelEffects::updateWaveEffect(int subtype)
 //   delay = random16(100, 250);
 // }
 
+void NeoPixelEffects::initTalkingEffect()
+{
+  _pixaoe = 3;
+  _counter = 0;
+  _direction = FORWARD;
+  _state.talking.due = 0;
+  _state.talking.target_pix = 0;
+  _state.talking.started = 0;
+}
+
 void NeoPixelEffects::updateTalkingEffect()
 {
   // Minimum 6 range
-  static uint8_t init = 1;
-  static uint8_t target_pix = 0;
-  static uint16_t next_update = 0;
-  static unsigned long lastupdate = 0;
+  uint8_t &target_pix = _state.talking.target_pix;
 
-  if (init) {
-    _pixaoe = 3;
-    _counter = 0;
-    _direction = FORWARD;
-    init = 0;
-  }
+  // _lastupdate holds the time of the tick being processed
+  unsigned long now = _lastupdate;
 
-  unsigned long now = millis();
-
-  if (now - lastupdate > next_update) {
-    lastupdate = now;
-    next_update = random16(150, 450); // About the min and max time between syllables
-    target_pix = random8(_pixaoe, _pixrange / 2);
+  // Frames further apart than any syllable always start a new one
+  if (!_state.talking.started || _delay > TALKING_HORIZON || !talkingSyllable(now)) {
+    uint32_t bits = nextRandom(randomState());
+    uint16_t next_update = 150 + (((bits >> 16) * 300) >> 16); // About the min and max time between syllables
+    _state.talking.due = (uint16_t)now + next_update;
+    _state.talking.started = 1;
+    target_pix = _pixaoe + (((bits & 0xFF) * (uint8_t)(_pixrange / 2 - _pixaoe)) >> 8);
     _direction = (target_pix > _counter) ? FORWARD : REVERSE;
   }
 
@@ -560,23 +1314,89 @@ void NeoPixelEffects::updateTalkingEffect()
         _pixset[_pixstart + (_pixrange / 2) + 1 + i] = _color_fg;
       }
     }
+    setLoad(_color_fg, _pixrange % 2 + 2 * _counter, CRGB::Black);
   } else {
+#if NEOPIXELEFFECTS_FIXED_POINT
+    CRGB dim1 = _color_fg;
+    dim1.nscale8(51);   // 20%
+    CRGB dim2 = _color_fg;
+    dim2.nscale8(26);   // 10%
+#else
     CRGB dim1 = CRGB(_color_fg.r * 0.2,_color_fg.g * 0.2, _color_fg.b * 0.2);
     CRGB dim2 = CRGB(_color_fg.r * 0.1,_color_fg.g * 0.1, _color_fg.b * 0.1);
+#endif
     _pixset[_pixstart + _pixrange / 2] = dim1;
     _pixset[_pixstart + _pixrange / 2 + 1] = dim2;
+    trackPixel(CRGB::Black, dim1);
+    trackPixel(CRGB::Black, dim2);
     if (_pixrange % 2 == 0) {
       _pixset[_pixstart + _pixrange / 2 - 1] = dim1;
       _pixset[_pixstart + _pixrange / 2 - 2] = dim2;
+      trackPixel(CRGB::Black, dim1);
     } else {
       _pixset[_pixstart + _pixrange / 2 - 1] = dim2;
     }
+    trackPixel(CRGB::Black, dim2);
   }
 }
 
+bool NeoPixelEffects::talkingClosed()
+{
+  return _effect == TALKING && _counter == 0 && _state.talking.target_pix == 0;
+}
+
+// True while the syllable is still running at now, which must lie within
+// TALKING_HORIZON of the last frame
+bool NeoPixelEffects::talkingSyllable(unsigned long now)
+{
+  return (int16_t)((uint16_t)now - _state.talking.due) <= 0;
+}
+
+bool NeoPixelEffects::talkingAtRest(unsigned long now)
+{
+  // A closed mouth repeats the same frame until the next syllable is due
+  return talkingClosed() && _state.talking.started && (millis_t)(now - _lastupdate) <= TALKING_HORIZON && talkingSyllable(now);
+}
+
+bool NeoPixelEffects::getNextUpdate(unsigned long &when)
+{
+  return getNextUpdate(when, millis());
+}
+
+bool NeoPixelEffects::getNextUpdate(unsigned long &when, unsigned long now)
+{
+  if (_status != ACTIVE || _effect == NONE) {
+    return false;
+  }
+
+  // update() fires once _delay has passed since the last scheduled frame
+  unsigned long wait = 0;
+  unsigned long elapsed = (millis_t)(now - _lastupdate);
+  if (!_resync && elapsed < _delay) {
+    wait = _delay - elapsed;
+  }
+
+  if (talkingAtRest(now)) {
+    // Round the syllable time up to the next scheduled tick
+    unsigned long syllable = (uint16_t)(_state.talking.due - (uint16_t)now) + 1;
+    if (syllable > wait) {
+      wait = syllable;
+      if (_delay > 0) {
+        unsigned long phase = (elapsed + wait) % _delay;
+        if (phase != 0) {
+          wait += _delay - phase;
+        }
+      }
+    }
+  }
+
+  when = now + wait;
+  return true;
+}
+
 Effect NeoPixelEffects::getEffect()
 {
-  return _effect;
+  return (Effect)_effect;
 }
 
 void NeoPixelEffects::setRange(int pixstart, int pixend)
@@ -585,13 +1405,14 @@ void NeoPixelEffects::setRange(int pixstart, int pixend)
     _pixstart = pixstart;
     _pixend = pixend;
     _pixrange = _pixend - _pixstart + 1;
+    countLoad();
   }
   if (_direction == FORWARD) {
     _pixcurrent = _pixstart;
   } else {
     _pixcurrent = _pixend;
   }
-  _lastupdate = 0;
+  _resync = true;
 }
 
 void NeoPixelEffects::setAreaOfEffect(int aoe)
@@ -599,59 +1420,387 @@ void NeoPixelEffects::setAreaOfEffect(int aoe)
   if (aoe > 0 && aoe <= _pixrange) {
     _pixaoe = aoe;
   }
-  _lastupdate = 0;
+  _resync = true;
 }
 
 void NeoPixelEffects::setDelayHz(int delay_hz)
 {
   if (delay_hz > 0) {
-    _delay = (unsigned long)(1.0 / delay_hz * 1000);
+    storeDelay(1000UL / delay_hz);
   }
   update();
 }
 
 void NeoPixelEffects::setDelay(unsigned long delay_ms)
 {
-  _delay = delay_ms;
-  _lastupdate = 0;
+  storeDelay(delay_ms);
   update();
 }
 
+void NeoPixelEffects::storeDelay(unsigned long delay_ms)
+{
+#if NEOPIXELEFFECTS_COMPACT
+  if (delay_ms > 65535) {
+    delay_ms = 65535;
+  }
+#endif
+  _delay = delay_ms;
+  _resync = true;
+}
+
 void NeoPixelEffects::setColor(CRGB color_crgb)
 {
   _color_fg = color_crgb;
-  _lastupdate = 0;
+  _resync = true;
 }
 
 void NeoPixelEffects::setBackgroundColor(CRGB color_crgb)
 {
   _color_bg = color_crgb;
-  _lastupdate = 0;
+  _resync = true;
 }
 
 void NeoPixelEffects::setStatus(EffectStatus status)
 {
   _status = status;
   if (status == ACTIVE) {
-    _lastupdate = 0;
+    _resync = true;
   }
 }
 
 EffectStatus NeoPixelEffects::getStatus()
 {
-  return(_status);
+  return (EffectStatus)_status;
 }
 
 void NeoPixelEffects::setRepeat(bool repeat)
 {
   _repeat = repeat;
-  _lastupdate = 0;
+  _resync = true;
 }
 
 void NeoPixelEffects::setDirection(bool direction)
 {
   _direction = direction;
-  _lastupdate = 0;
+  _startdirection = direction;
+  _resync = true;
+}
+
+void NeoPixelEffects::setSeed(uint32_t seed)
+{
+  // Mix the seed so nearby seeds give unrelated sequences. xorshift stays at
+  // 0 forever, so that state is replaced.
+  seed ^= seed >> 16;
+  seed *= 0x7FEB352D;
+  seed ^= seed >> 15;
+  seed *= 0x846CA68B;
+  seed ^= seed >> 16;
+  randomState() = (seed != 0) ? seed : 0x9E3779B9;
+}
+
+uint32_t &NeoPixelEffects::randomState()
+{
+#if NEOPIXELEFFECTS_SEEDS
+  return _random;
+#else
+  return shared_random;
+#endif
+}
+
+#if NEOPIXELEFFECTS_PARTICLES
+void NeoPixelEffects::setParticles(NeoPixelEffectsParticles *particles)
+{
+  _particles = particles;
+  if (_particles != NULL) {
+    _particles->clear();
+  }
+}
+#endif
+
+#if NEOPIXELEFFECTS_CACHE
+void NeoPixelEffects::setCache(NeoPixelEffectsCache *cache)
+{
+  _cache = cache;
+}
+#endif
+
+void NeoPixelEffects::setIncremental(bool incremental)
+{
+  _incremental = incremental;
+  _scrollvalid = false;
+}
+
+bool NeoPixelEffects::getIncremental()
+{
+  return _incremental;
+}
+
+void NeoPixelEffects::setTimingPolicy(TimingPolicy policy)
+{
+  _timing = policy;
+}
+
+TimingPolicy NeoPixelEffects::getTimingPolicy()
+{
+  return (TimingPolicy)_timing;
+}
+
+// Grows the dirty range to cover first..last
+void NeoPixelEffects::markDirty(int first, int last)
+{
+#if NEOPIXELEFFECTS_DIRTY
+  if (_dirtyend < _dirtystart) {
+    _dirtystart = first;
+    _dirtyend = last;
+  } else {
+    if (first < _dirtystart) _dirtystart = first;
+    if (last > _dirtyend) _dirtyend = last;
+  }
+#else
+  (void)first;
+  (void)last;
+  _dirty = true;
+#endif
+}
+
+bool NeoPixelEffects::getDirtyRange(int &first, int &last)
+{
+#if NEOPIXELEFFECTS_DIRTY
+  if (_dirtyend < _dirtystart) {
+    return false;
+  }
+  first = _dirtystart;
+  last = _dirtyend;
+#else
+  // Only that something was written is known, so report the whole range
+  if (!_dirty) {
+    return false;
+  }
+  first = _pixstart;
+  last = _pixend;
+#endif
+  return true;
+}
+
+void NeoPixelEffects::clearDirty()
+{
+#if NEOPIXELEFFECTS_DIRTY
+  _dirtystart = 1;
+  _dirtyend = 0;
+#else
+  _dirty = false;
+#endif
+}
+
+// With NEOPIXELEFFECTS_POWER each drawing routine keeps _load current in the
+// cheapest way its writes allow: a fill sets it outright, a scroll or a
+// single pixel adjusts it, and a full redraw adds up the pixels as it
+// writes them. Only setRange() and measureLoad() read the range back.
+// Without it these compile to nothing.
+
+// Every pixel in the range is color
+void NeoPixelEffects::setLoad(CRGB color)
+{
+#if NEOPIXELEFFECTS_POWER
+  _load = (uint32_t)_pixrange * pixelLoad(color);
+#else
+  (void)color;
+#endif
+}
+
+// count pixels are color and the rest of the range other
+void NeoPixelEffects::setLoad(CRGB color, int count, CRGB other)
+{
+#if NEOPIXELEFFECTS_POWER
+  _load = (uint32_t)count * pixelLoad(color) + (uint32_t)(_pixrange - count) * pixelLoad(other);
+#else
+  (void)color;
+  (void)count;
+  (void)other;
+#endif
+}
+
+// The pixels in the range add up to load
+void NeoPixelEffects::storeLoad(uint32_t load)
+{
+#if NEOPIXELEFFECTS_POWER
+  _load = load;
+#else
+  (void)load;
+#endif
+}
+
+// Pixels in the range grew by load in total
+void NeoPixelEffects::addLoad(uint32_t load)
+{
+#if NEOPIXELEFFECTS_POWER
+  _load += load;
+#else
+  (void)load;
+#endif
+}
+
+// A pixel showing before now shows after
+void NeoPixelEffects::trackPixel(CRGB before, CRGB after)
+{
+#if NEOPIXELEFFECTS_POWER
+  _load += pixelLoad(after);
+  _load -= pixelLoad(before);
+#else
+  (void)before;
+  (void)after;
+#endif
+}
+
+void NeoPixelEffects::countLoad()
+{
+#if NEOPIXELEFFECTS_POWER
+  _load = (_pixset != NULL) ? sumPixels(_pixset + _pixstart, _pixrange) : 0;
+#endif
+}
+
+#if NEOPIXELEFFECTS_POWER
+uint32_t NeoPixelEffects::getLoad()
+{
+  return _load;
+}
+
+unsigned long NeoPixelEffects::getCurrent()
+{
+  return ((unsigned long)_load * NEOPIXELEFFECTS_CHANNEL_MA + 127) / 255 + (unsigned long)_pixrange * NEOPIXELEFFECTS_IDLE_MA;
+}
+
+void NeoPixelEffects::measureLoad()
+{
+  countLoad();
+}
+#endif
+
+#if NEOPIXELEFFECTS_STATS
+void NeoPixelEffectsStats::reset()
+{
+  calls = 0;
+  frames = 0;
+  late = 0;
+  missed = 0;
+  totaltime = 0;
+  maxtime = 0;
+  totaljitter = 0;
+  maxjitter = 0;
+}
+
+void NeoPixelEffectsStats::add(const NeoPixelEffectsStats &other)
+{
+  calls += other.calls;
+  frames += other.frames;
+  late += other.late;
+  missed += other.missed;
+  totaltime += other.totaltime;
+  maxtime = max(maxtime, other.maxtime);
+  totaljitter += other.totaljitter;
+  maxjitter = max(maxjitter, other.maxjitter);
+}
+
+unsigned long NeoPixelEffectsStats::getMeanTime() const
+{
+  return (frames > 0) ? totaltime / frames : 0;
+}
+
+unsigned long NeoPixelEffectsStats::getMeanJitter() const
+{
+  return (frames > 0) ? totaljitter / frames : 0;
+}
+
+void NeoPixelEffectsStats::print(Print &out) const
+{
+  out.print(calls);
+  out.print(',');
+  out.print(frames);
+  out.print(',');
+  out.print(late);
+  out.print(',');
+  out.print(missed);
+  out.print(',');
+  out.print(totaltime);
+  out.print(',');
+  out.print(getMeanTime());
+  out.print(',');
+  out.print(maxtime);
+  out.print(',');
+  out.print(getMeanJitter());
+  out.print(',');
+  out.println(maxjitter);
+}
+
+// Called at the end of a rendered frame; _lastupdate holds its scheduled tick
+void NeoPixelEffects::recordFrame(unsigned long now, unsigned long missed, unsigned long started)
+{
+  unsigned long elapsed = micros() - started;
+  unsigned long jitter = (millis_t)(now - _lastupdate);
+
+  _stats.frames++;
+  if (missed > 0) {
+    _stats.late++;
+    _stats.missed += missed;
+  }
+  _stats.totaltime += elapsed;
+  _stats.maxtime = max(_stats.maxtime, elapsed);
+  _stats.totaljitter += jitter;
+  _stats.maxjitter = max(_stats.maxjitter, jitter);
+}
+
+const NeoPixelEffectsStats &NeoPixelEffects::getStats()
+{
+  return _stats;
+}
+
+void NeoPixelEffects::resetStats()
+{
+  _stats.reset();
+}
+
+static void printEffectName(Print &out, uint8_t effect)
+{
+  switch (effect) {
+    case COMET: out.print(F("COMET")); break;
+    case LARSON: out.print(F("LARSON")); break;
+    case CHASE: out.print(F("CHASE")); break;
+    case PULSE: out.print(F("PULSE")); break;
+    case STATIC: out.print(F("STATIC")); break;
+    case FADE: out.print(F("FADE")); break;
+    case FILLIN: out.print(F("FILLIN")); break;
+    case GLOW: out.print(F("GLOW")); break;
+    case RAINBOWWAVE: out.print(F("RAINBOWWAVE")); break;
+    case STROBE: out.print(F("STROBE")); break;
+    case SINEWAVE: out.print(F("SINEWAVE")); break;
+    case RANDOM: out.print(F("RANDOM")); break;
+    case TALKING: out.print(F("TALKING")); break;
+    case TRIWAVE: out.print(F("TRIWAVE")); break;
+    case FIREWORK: out.print(F("FIREWORK")); break;
+    case SPARKLEFILL: out.print(F("SPARKLEFILL")); break;
+    default: out.print(F("NONE")); break;
+  }
+}
+
+void NeoPixelEffects::printStats(Print &out)
+{
+  printEffectName(out, _effect);
+  out.print(',');
+  out.print(_pixrange);
+  out.print(',');
+  _stats.print(out);
+}
+
+#endif
+
+unsigned int NeoPixelEffects::getLateFrames()
+{
+  return _lateframes;
+}
+
+void NeoPixelEffects::resetLateFrames()
+{
+  _lateframes = 0;
 }
 
 void NeoPixelEffects::stop()
@@ -682,22 +1831,51 @@ void NeoPixelEffects::clear()
 
 void NeoPixelEffects::fill_solid(CRGB color_crgb)
 {
-  for (int i = _pixstart; i <= _pixend; i++) {
-    _pixset[i] = color_crgb;
-  }
+  fillPixels(_pixset + _pixstart, _pixrange, color_crgb);
+  setLoad(color_crgb);
+  markDirty(_pixstart, _pixend);
+  _scrollvalid = false;
 }
 
 void NeoPixelEffects::fill_gradient(CRGB color_crgb1, CRGB color_crgb2)
 {
+  markDirty(_pixstart, _pixend);
+  _scrollvalid = false;
   int delta_red = color_crgb1.r - color_crgb2.r;
   int delta_green = color_crgb1.g - color_crgb2.g;
   int delta_blue = color_crgb1.b - color_crgb2.b;
+  uint32_t load = 0;
 
+#if NEOPIXELEFFECTS_FIXED_POINT
+  // Position within the range as a 0.16 fraction, (i - _pixstart) * 65536
+  // / _pixrange rounded down. Its quotient and remainder are stepped once
+  // per pixel, so the fraction never drifts past the end of the range.
+  uint32_t part = 0;
+  uint32_t part_step = 65536UL / _pixrange;
+  long rem = 0;
+  long rem_step = 65536L % _pixrange;
+  for (int i = _pixstart; i <= _pixend; i++) {
+    uint8_t grad_red = color_crgb1.r - (int)(((long)delta_red * (long)part + 65535) >> 16);
+    uint8_t grad_green = color_crgb1.g - (int)(((long)delta_green * (long)part + 65535) >> 16);
+    uint8_t grad_blue = color_crgb1.b - (int)(((long)delta_blue * (long)part + 65535) >> 16);
+    _pixset[i] = CRGB(grad_red, grad_green, grad_blue);
+    load += grad_red + grad_green + grad_blue;
+    part += part_step;
+    rem += rem_step;
+    if (rem >= _pixrange) {
+      rem -= _pixrange;
+      part++;
+    }
+  }
+#else
   for (int i = _pixstart; i <= _pixend; i++) {
     float part = (float)(i - _pixstart) / _pixrange;
     uint8_t grad_red = color_crgb1.r - (delta_red * part);
     uint8_t grad_green = color_crgb1.g - (delta_green * part);
     uint8_t grad_blue = color_crgb1.b - (delta_blue * part);
     _pixset[i] = CRGB(grad_red, grad_green, grad_blue);
+    load += grad_red + grad_green + grad_blue;
   }
+#endif
+  storeLoad(load);
 }
@@ -25,6 +25,92 @@
  #include <pins_arduino.h>
 #endif
 
+// Render with integer scale8() math instead of per-pixel floating point.
+// Define as 0 to use the original floating point path.
+#ifndef NEOPIXELEFFECTS_FIXED_POINT
+ #define NEOPIXELEFFECTS_FIXED_POINT 1
+#endif
+
+// Most ticks TIMING_CATCHUP will replay after a stall before giving up
+#ifndef NEOPIXELEFFECTS_MAX_CATCHUP
+ #define NEOPIXELEFFECTS_MAX_CATCHUP 255
+#endif
+
+// Store each effect in as little RAM as possible: 16-bit pixel indices and
+// delay, byte-sized enums and single-bit flags. Limits ranges to 32767
+// pixels and delays to 65535 ms. On by default on AVR.
+#ifndef NEOPIXELEFFECTS_COMPACT
+ #ifdef __AVR__
+  #define NEOPIXELEFFECTS_COMPACT 1
+ #else
+  #define NEOPIXELEFFECTS_COMPACT 0
+ #endif
+#endif
+
+// Let SINEWAVE, TRIWAVE and RAINBOWWAVE draw from a NeoPixelEffectsCache
+// handed to setCache(). Costs a pointer per effect. On by default except
+// in compact builds.
+#ifndef NEOPIXELEFFECTS_CACHE
+ #if NEOPIXELEFFECTS_COMPACT
+  #define NEOPIXELEFFECTS_CACHE 0
+ #else
+  #define NEOPIXELEFFECTS_CACHE 1
+ #endif
+#endif
+
+// Give every effect its own random generator, so that segments never
+// sparkle in step and setSeed() replays one effect exactly whatever the
+// others do. Without it all effects share one generator, which saves 4
+// bytes per effect. On by default.
+#ifndef NEOPIXELEFFECTS_SEEDS
+ #define NEOPIXELEFFECTS_SEEDS 1
+#endif
+
+// Keep the exact span of pixels each effect wrote since clearDirty().
+// Without it an effect only remembers that it wrote something, and
+// getDirtyRange() reports its whole range, which saves two indices per
+// effect. On by default.
+#ifndef NEOPIXELEFFECTS_DIRTY
+ #define NEOPIXELEFFECTS_DIRTY 1
+#endif
+
+// Let FIREWORK and SPARKLEFILL draw sparks from a NeoPixelEffectsParticles
+// pool handed to setParticles(). Costs a pointer per effect. On by default.
+#ifndef NEOPIXELEFFECTS_PARTICLES
+ #define NEOPIXELEFFECTS_PARTICLES 1
+#endif
+
+// Count calls, render time and timing jitter for every effect, readable
+// with getStats() and printStats(). Costs two micros() calls per frame and
+// eight longs per effect, so it is off by default.
+#ifndef NEOPIXELEFFECTS_STATS
+ #define NEOPIXELEFFECTS_STATS 0
+#endif
+
+// Keep a running sum of the channel values each effect has drawn, so the
+// current it draws can be read without scanning the strip. Adds a long per
+// effect and a few instructions per frame, so it is off by default.
+#ifndef NEOPIXELEFFECTS_POWER
+ #define NEOPIXELEFFECTS_POWER 0
+#endif
+
+// Power model for getCurrent(): mA drawn by one channel at full brightness
+// and by an unlit pixel, as for a WS2812B at 5 V
+#ifndef NEOPIXELEFFECTS_CHANNEL_MA
+ #define NEOPIXELEFFECTS_CHANNEL_MA 20
+#endif
+#ifndef NEOPIXELEFFECTS_IDLE_MA
+ #define NEOPIXELEFFECTS_IDLE_MA 1
+#endif
+
+// Threaded helpers are only available where the toolchain ships
+// std::thread (Linux hosts, ESP32)
+#if defined(__has_include)
+ #if __has_include(<thread>) && __has_include(<condition_variable>)
+  #define NEOPIXELEFFECTS_HAS_THREADS 1
+ #endif
+#endif
+
 #define FORWARD true
 #define REVERSE false
 
@@ -45,8 +131,8 @@ enum Effect {
   TALKING,
   TRIWAVE,
   // INVERSELARSON,
-  // FIREWORK,
-  // SPARKLEFILL,
+  FIREWORK,
+  SPARKLEFILL,
   NUM_EFFECT
 };
 
@@ -56,7 +142,93 @@ enum EffectStatus {
   NUM_EFFECTSTATUS
 };
 
+// What update() does with ticks that were missed because it was called late
+enum TimingPolicy {
+  TIMING_SKIP,      // Drop them and render the current tick only
+  TIMING_CATCHUP,   // Advance the effect through them, then render the current tick
+  NUM_TIMINGPOLICY
+};
+
+// Lookup tables that let SINEWAVE, TRIWAVE and RAINBOWWAVE draw each pixel
+// with a table read instead of a division and a colour calculation. The
+// sketch owns it and hands it to setCache(); it takes 768 bytes plus one
+// byte per pixel for the optional phase table. It is rebuilt whenever the
+// effect, colour or range it was built for changes. A phase table filled by
+// the sketch lays the waves and the rainbow out in any shape, such as
+// rings over a matrix.
+struct NeoPixelEffectsCache {
+  NeoPixelEffectsCache(uint8_t *phase_table = NULL, int phase_count = 0);
+
+  CRGB ramp[256];       // Colour for each wave phase or rainbow hue
+  uint8_t *phases;      // Phase offset of each pixel in the range, or NULL
+  int phasecount;       // Length of phases; unused if shorter than the range
+  bool keepphases;      // The sketch filled phases, e.g. with NeoPixelEffectsMap::matrixPhases(); never rebuild them
+  bool valid;
+  Effect effect;        // Settings the tables were built for
+  CRGB color;
+  int pixstart;
+  int pixrange;
+};
+
+class NeoPixelEffectsParticles;
+
+// Counters kept for each effect when NEOPIXELEFFECTS_STATS is set. Render
+// time covers the whole frame, including ticks replayed by TIMING_CATCHUP.
+// Jitter is how long after its scheduled tick a frame was rendered.
+struct NeoPixelEffectsStats {
+  unsigned long calls;        // update() calls
+  unsigned long frames;       // Frames rendered
+  unsigned long late;         // Frames rendered after one or more ticks were missed
+  unsigned long missed;       // Ticks missed
+  unsigned long totaltime;    // Render time, in microseconds
+  unsigned long maxtime;
+  unsigned long totaljitter;  // Jitter, in milliseconds
+  unsigned long maxjitter;
+
+  void reset();
+  void add(const NeoPixelEffectsStats &other);
+  unsigned long getMeanTime() const;
+  unsigned long getMeanJitter() const;
+#if NEOPIXELEFFECTS_STATS
+  void print(Print &out) const;   // The counters as CSV columns, ending the line
+#endif
+};
+
 class NeoPixelEffects {
+#if NEOPIXELEFFECTS_COMPACT
+    typedef int16_t index_t;
+    typedef uint16_t delay_t;
+    typedef uint16_t count_t;
+    typedef uint32_t millis_t;  // millis() wraps at 32 bits on every board
+#else
+    typedef int index_t;
+    typedef unsigned long delay_t;
+    typedef unsigned int count_t;
+    typedef unsigned long millis_t;
+#endif
+
+    // State owned by whichever effect is running; only one runs at a time.
+    // The comet and glow members only depend on the settings and are
+    // rebuilt by deriveState() when a setter starts a new timeline.
+    union EffectState {
+      struct {
+        uint32_t tailstep;          // Tail brightness step per pixel, 16.16
+      } comet;
+      struct {
+        index_t aoe;                // Area of effect with the parity of the range
+        index_t half;               // Pixels of falloff on each side
+      } glow;
+      struct {
+        uint16_t due;               // Low 16 bits of the time the current syllable ends
+        uint8_t target_pix;         // Mouth width being moved towards
+        uint8_t started;            // A syllable has started and due is valid
+      } talking;
+      struct {
+        uint8_t phase;              // Stage of the firework or fill
+        uint8_t wait;               // Frames left before the next stage
+      } particles;
+    };
+
   public:
     NeoPixelEffects(CRGB *pix, Effect effect, int pixstart, int pixend, int aoe, unsigned long delay, CRGB color_crgb, bool looping, bool dir);
     NeoPixelEffects();
@@ -74,8 +246,37 @@ class NeoPixelEffects {
     void setDelayHz(int delay_hz);
     void setRepeat(bool repeat);
     void setDirection(bool direction);
+    void setSeed(uint32_t seed);    // Restart the effect's random sequence (the shared one without NEOPIXELEFFECTS_SEEDS), same seed gives the same frames
+#if NEOPIXELEFFECTS_CACHE
+    void setCache(NeoPixelEffectsCache *cache); // Draw waves and rainbows from lookup tables, NULL to stop
+#endif
+#if NEOPIXELEFFECTS_PARTICLES
+    void setParticles(NeoPixelEffectsParticles *particles); // Spark pool for FIREWORK and SPARKLEFILL
+#endif
+    void setIncremental(bool incremental); // Scroll CHASE and RAINBOWWAVE instead of redrawing them
+    bool getIncremental();
+    void setTimingPolicy(TimingPolicy policy);
+    TimingPolicy getTimingPolicy();
+    unsigned int getLateFrames();   // Ticks missed since the last reset
+    void resetLateFrames();
+    bool getNextUpdate(unsigned long &when); // Time the next frame is due, false if none is scheduled
+    bool getNextUpdate(unsigned long &when, unsigned long now);
+    bool getDirtyRange(int &first, int &last); // Pixels written since clearDirty(), false if none
+    void clearDirty();
+#if NEOPIXELEFFECTS_STATS
+    const NeoPixelEffectsStats &getStats();
+    void resetStats();
+    void printStats(Print &out);  // One CSV row in the format of NeoPixelEffectsManager::printStats()
+#endif
+#if NEOPIXELEFFECTS_POWER
+    uint32_t getLoad();           // Sum of every channel of the pixels in the range
+    unsigned long getCurrent();   // Estimated draw of the range, in mA
+    void measureLoad();           // Recount the load after the sketch drew into the range itself
+#endif
 
-    void update(); // Process effect
+    bool update(); // Process effect, returns true if pixels were rendered
+    bool update(unsigned long now); // Process effect against a caller-supplied clock, in milliseconds
+    bool render(unsigned long tick); // Draw the frame shown this many ticks after the effect started
     void stop();
     void pause();
     void play();
@@ -84,8 +285,44 @@ class NeoPixelEffects {
     void fill_solid(CRGB color_crgb);
     void fill_gradient(CRGB color_crgb1, CRGB color_crgb2);
 
-  private:
+  protected:
+    typedef void (*StepFunction)(NeoPixelEffects &effect);
+
+    NeoPixelEffects(CRGB *pix, int pixstart, int pixend, int aoe, unsigned long delay, CRGB color_crgb, bool looping, bool dir);
+
+    bool runFrame(unsigned long now, StepFunction step);
+    bool beginFrame(unsigned long now, unsigned long &missed);
+#if NEOPIXELEFFECTS_STATS
+    void recordFrame(unsigned long now, unsigned long missed, unsigned long started);
+#endif
+    void storeDelay(unsigned long delay_ms);
+    uint32_t &randomState();
+    void markDirty(int first, int last);
+    void setLoad(CRGB color);
+    void setLoad(CRGB color, int count, CRGB other);
+    void storeLoad(uint32_t load);
+    void addLoad(uint32_t load);
+    void trackPixel(CRGB before, CRGB after);
+    void countLoad();
+    static void stepAny(NeoPixelEffects &effect);
+    void stepEffect();
+    bool advanceEffect();
+    bool advanceBounce();
+    void catchUp(unsigned long steps, StepFunction step);
     void updateCometEffect(int subtype);
+    void drawComet(int current, bool direction, bool repeat);
+    void drawChase(int counter);
+    void drawStrobe(int counter);
+    void drawGlow(int counter);
+    void drawPulse(int counter);
+    void drawRainbowWave(int counter);
+    CRGB rainbowColor(long position);
+    bool useCache();
+    bool usePhases();
+    const CRGB *cacheRamp();
+    NeoPixelEffectsParticles *particlePool();
+    void deriveState();
+    void drawWave(int counter, int subtype);
     void updateChaseEffect();
     void updatePulseEffect();
     void updateStaticEffect(int subtype);
@@ -96,31 +333,82 @@ class NeoPixelEffects {
     void updateRainbowWaveEffect();
     void updateStrobeEffect();
     void updateWaveEffect(int subtype);
+    void initTalkingEffect();
     void updateTalkingEffect();
-    // void initTalkingEffect();
+    bool talkingClosed();
+    bool talkingSyllable(unsigned long now);
+    bool talkingAtRest(unsigned long now);
     // void initTalkingEffect1(uint8_t &brightness_array, uint16_t &delay_array, uint8_t &maxb, uint8_t &minb, uint8_t &current_b);
-    // void updateFireworkEffect();
-    // void updateSparkleFillEffect();
+    void initParticleEffect();
+    void updateFireworkEffect();
+    void updateSparkleFillEffect();
 
+    // Members are ordered from widest to narrowest to avoid padding
     CRGB *_pixset;          // A reference to the one created in the user code
-    CRGB _color_fg;
-    CRGB _color_bg;
-    Effect _effect;         // Your silly or awesome effect!
-    EffectStatus _status;
-    int
+#if NEOPIXELEFFECTS_CACHE
+    NeoPixelEffectsCache *_cache; // Optional lookup tables, owned by the user code
+#endif
+#if NEOPIXELEFFECTS_PARTICLES
+    NeoPixelEffectsParticles *_particles; // Spark pool, owned by the user code
+#endif
+    millis_t _lastupdate;   // Scheduled time of the last frame, in milliseconds since sys reboot
+    EffectState _state;
+#if NEOPIXELEFFECTS_STATS
+    NeoPixelEffectsStats _stats;
+#endif
+#if NEOPIXELEFFECTS_POWER
+    uint32_t _load;         // Sum of every channel of the pixels in the range
+#endif
+#if NEOPIXELEFFECTS_SEEDS
+    uint32_t _random;       // State of the effect's own xorshift generator, never 0
+#endif
+    index_t
       _pixstart,            // First NeoPixel in range of effect
       _pixend,              // Last NeoPixel in range of effect
       _pixrange,            // Length of effect area
       _pixaoe,              // The length of the effect that takes place within the range
       _pixcurrent,          // Head pixel that indicates current pixel to base effect on
       _counter;
-    uint8_t _subtype;          // Defines sub type to be used
+#if NEOPIXELEFFECTS_DIRTY
+    index_t
+      _dirtystart,          // First pixel written since clearDirty()
+      _dirtyend;            // Last pixel written, before _dirtystart when nothing was
+#endif
+    delay_t _delay;         // Period at which effect should update, in milliseconds
+    count_t _lateframes;    // Ticks missed because update() was called late
+    CRGB _color_fg;
+    CRGB _color_bg;
+#if NEOPIXELEFFECTS_COMPACT
+    // The effect and every flag share two bytes
+    uint8_t
+      _effect : 5,          // Your silly or awesome effect!
+      _status : 1,
+      _timing : 1;
+    bool
+      _repeat : 1,          // Whether or not the effect loops in area
+      _direction : 1,       // Whether or not the effect moves from start to end pixel
+      _startdirection : 1,  // Direction the effect was started with
+      _resync : 1,          // Start a new timeline on the next update
+      _incremental : 1,     // Scroll the last frame where the effect allows it
+      _scrollvalid : 1;     // The range still holds the frame drawn last
+#if !NEOPIXELEFFECTS_DIRTY
+    bool _dirty : 1;        // Pixels were written since clearDirty()
+#endif
+#else
+    Effect _effect;         // Your silly or awesome effect!
+    EffectStatus _status;
+    TimingPolicy _timing;
     bool
       _repeat,              // Whether or not the effect loops in area
-      _direction;           // Whether or not the effect moves from start to end pixel
-    unsigned long
-      _lastupdate,          // Last update time, in milliseconds since sys reboot
-      _delay;               // Period at which effect should update, in milliseconds
+      _direction,           // Whether or not the effect moves from start to end pixel
+      _startdirection,      // Direction the effect was started with
+      _resync,              // Start a new timeline on the next update
+      _incremental,         // Scroll the last frame where the effect allows it
+      _scrollvalid;         // The range still holds the frame drawn last
+#if !NEOPIXELEFFECTS_DIRTY
+    bool _dirty;            // Pixels were written since clearDirty()
+#endif
+#endif
 };
 
 #endif
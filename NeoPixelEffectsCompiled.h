@@ -0,0 +1,150 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSCOMPILED_H
+#define NEOPIXELEFFECTSCOMPILED_H
+
+#include <NeoPixelEffects.h>
+
+// An effect whose kind is fixed when the sketch is compiled, e.g.
+//   NeoPixelEffectsCompiled<COMET> comet(leds, 0, 59, 8, 20, CRGB::Red, true, FORWARD);
+// update() calls the one effect directly instead of going through the
+// switch in NeoPixelEffects::update(), so the code of every other effect is
+// left out of the sketch. Keep that saving by driving these objects directly:
+// the base class update() and setDelay(), and NeoPixelEffectsManager, pull
+// every effect back in.
+template <Effect E>
+class NeoPixelEffectsCompiled : public NeoPixelEffects {
+  public:
+    NeoPixelEffectsCompiled(CRGB *pix, int pixstart, int pixend, int aoe, unsigned long delay, CRGB color_crgb, bool looping, bool dir);
+
+    void setEffect();   // Restarts the effect
+    void setDelay(unsigned long delay_ms);
+    void setDelayHz(int delay_hz);
+
+    bool update();
+    bool update(unsigned long now);
+
+  private:
+    static void stepCompiled(NeoPixelEffects &effect);
+    void stepEffect();
+};
+
+template <Effect E>
+NeoPixelEffectsCompiled<E>::NeoPixelEffectsCompiled(CRGB *pix, int pixstart, int pixend, int aoe, unsigned long delay, CRGB color_crgb, bool looping, bool dir) :
+  NeoPixelEffects(pix, pixstart, pixend, aoe, delay, color_crgb, looping, dir)
+{
+  setEffect();
+}
+
+template <Effect E>
+void NeoPixelEffectsCompiled<E>::setEffect()
+{
+  NeoPixelEffects::setEffect(E);
+}
+
+template <Effect E>
+void NeoPixelEffectsCompiled<E>::setDelay(unsigned long delay_ms)
+{
+  storeDelay(delay_ms);
+  update();
+}
+
+template <Effect E>
+void NeoPixelEffectsCompiled<E>::setDelayHz(int delay_hz)
+{
+  if (delay_hz > 0) {
+    storeDelay(1000UL / delay_hz);
+  }
+  update();
+}
+
+template <Effect E>
+bool NeoPixelEffectsCompiled<E>::update()
+{
+  return update(millis());
+}
+
+template <Effect E>
+bool NeoPixelEffectsCompiled<E>::update(unsigned long now)
+{
+  return runFrame(now, &NeoPixelEffectsCompiled<E>::stepCompiled);
+}
+
+template <Effect E>
+void NeoPixelEffectsCompiled<E>::stepCompiled(NeoPixelEffects &effect)
+{
+  static_cast<NeoPixelEffectsCompiled<E> &>(effect).stepEffect();
+}
+
+// E is a constant, so the compiler keeps only the matching case
+template <Effect E>
+void NeoPixelEffectsCompiled<E>::stepEffect()
+{
+  switch (E) {
+    case COMET:
+      updateCometEffect(0);
+      break;
+    case LARSON:
+      updateCometEffect(1);
+      break;
+    case CHASE:
+      updateChaseEffect();
+      break;
+    case PULSE:
+      updatePulseEffect();
+      break;
+    case STATIC:
+      updateStaticEffect(0);
+      break;
+    case RANDOM:
+      updateStaticEffect(1);
+      break;
+    case FADE:
+      updateFadeOutEffect();
+      break;
+    case FILLIN:
+      updateFillInEffect();
+      break;
+    case GLOW:
+      updateGlowEffect();
+      break;
+    case RAINBOWWAVE:
+      updateRainbowWaveEffect();
+      break;
+    case STROBE:
+      updateStrobeEffect();
+      break;
+    case SINEWAVE:
+      updateWaveEffect(0);
+      break;
+    case TRIWAVE:
+      updateWaveEffect(1);
+      break;
+    case TALKING:
+      updateTalkingEffect();
+      break;
+    case FIREWORK:
+      updateFireworkEffect();
+      break;
+    case SPARKLEFILL:
+      updateSparkleFillEffect();
+      break;
+    default:
+      break;
+  }
+}
+
+#endif
@@ -0,0 +1,256 @@
+/*-------------------------------------------------------------------------
+  Layered compositing of several NeoPixelEffects into one LED buffer.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsCompositor.h>
+#include <NeoPixelEffectsKernels.h>
+
+// Pixels composited at a time; the chunk stays in registers or cache while
+// every layer is blended into it, and is written to the output once
+#define COMPOSITE_CHUNK 32
+
+// a faded towards b by amount / 255, rounded, exact at both ends
+static inline uint8_t mix8(uint8_t a, uint8_t b, uint8_t amount)
+{
+  uint16_t w = amount + (amount >> 7);
+  return (a * (256 - w) + b * w + 128) >> 8;
+}
+
+// a * b / 255, rounded
+static inline uint8_t multiply8(uint8_t a, uint8_t b)
+{
+  uint16_t t = a * b + 128;
+  return (t + (t >> 8)) >> 8;
+}
+
+// Blends count layer pixels from src into dst
+static void blendPixels(CRGB *dst, const CRGB *src, int count, uint8_t mode, uint8_t alpha)
+{
+  switch (mode) {
+    case BLEND_NORMAL:
+      if (alpha == 255) {
+        memcpy(dst, src, count * sizeof(CRGB));
+      } else {
+        for (int i = 0; i < count; i++) {
+          dst[i].r = mix8(dst[i].r, src[i].r, alpha);
+          dst[i].g = mix8(dst[i].g, src[i].g, alpha);
+          dst[i].b = mix8(dst[i].b, src[i].b, alpha);
+        }
+      }
+      break;
+    case BLEND_ADD:
+      for (int i = 0; i < count; i++) {
+        dst[i].r = mix8(dst[i].r, qadd8(dst[i].r, src[i].r), alpha);
+        dst[i].g = mix8(dst[i].g, qadd8(dst[i].g, src[i].g), alpha);
+        dst[i].b = mix8(dst[i].b, qadd8(dst[i].b, src[i].b), alpha);
+      }
+      break;
+    case BLEND_MAX:
+      for (int i = 0; i < count; i++) {
+        dst[i].r = mix8(dst[i].r, max(dst[i].r, src[i].r), alpha);
+        dst[i].g = mix8(dst[i].g, max(dst[i].g, src[i].g), alpha);
+        dst[i].b = mix8(dst[i].b, max(dst[i].b, src[i].b), alpha);
+      }
+      break;
+    case BLEND_MULTIPLY:
+      for (int i = 0; i < count; i++) {
+        dst[i].r = mix8(dst[i].r, multiply8(dst[i].r, src[i].r), alpha);
+        dst[i].g = mix8(dst[i].g, multiply8(dst[i].g, src[i].g), alpha);
+        dst[i].b = mix8(dst[i].b, multiply8(dst[i].b, src[i].b), alpha);
+      }
+      break;
+    case BLEND_ALPHA:
+      for (int i = 0; i < count; i++) {
+        uint8_t cover = max(src[i].r, max(src[i].g, src[i].b));
+        if (cover == 0) {
+          continue;
+        }
+        if (alpha != 255) {
+          cover = multiply8(cover, alpha);
+        }
+        dst[i].r = mix8(dst[i].r, src[i].r, cover);
+        dst[i].g = mix8(dst[i].g, src[i].g, cover);
+        dst[i].b = mix8(dst[i].b, src[i].b, cover);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+NeoPixelEffectsCompositor::NeoPixelEffectsCompositor(CRGB *output, int numpix) :
+  _output(output), _numpix(numpix), _count(0), _background(CRGB::Black), _full(true),
+  _dirtystart(1), _dirtyend(0)
+{
+}
+
+int NeoPixelEffectsCompositor::addLayer(NeoPixelEffects *effect, CRGB *pixels, BlendMode mode, uint8_t alpha)
+{
+  return addTile(effect, pixels, 0, _numpix, mode, alpha);
+}
+
+int NeoPixelEffectsCompositor::addTile(NeoPixelEffects *effect, CRGB *pixels, int first, int count, BlendMode mode, uint8_t alpha)
+{
+  if (pixels == NULL || _count >= NEOPIXELEFFECTS_MAX_LAYERS || first < 0 || count <= 0 || first + count > _numpix) {
+    return -1;
+  }
+  Layer &layer = _layers[_count];
+  layer.effect = effect;
+  layer.pixels = pixels;
+  layer.first = first;
+  layer.count = count;
+  layer.mode = mode;
+  layer.alpha = alpha;
+  layer.visible = true;
+  _full = true;
+  return _count++;
+}
+
+void NeoPixelEffectsCompositor::removeAll()
+{
+  _count = 0;
+  _full = true;
+}
+
+int NeoPixelEffectsCompositor::getCount()
+{
+  return _count;
+}
+
+void NeoPixelEffectsCompositor::setLayerMode(int layer, BlendMode mode)
+{
+  if (layer >= 0 && layer < _count && _layers[layer].mode != mode) {
+    _layers[layer].mode = mode;
+    _full = true;
+  }
+}
+
+void NeoPixelEffectsCompositor::setLayerAlpha(int layer, uint8_t alpha)
+{
+  if (layer >= 0 && layer < _count && _layers[layer].alpha != alpha) {
+    _layers[layer].alpha = alpha;
+    _full = true;
+  }
+}
+
+void NeoPixelEffectsCompositor::setLayerVisible(int layer, bool visible)
+{
+  if (layer >= 0 && layer < _count && _layers[layer].visible != visible) {
+    _layers[layer].visible = visible;
+    _full = true;
+  }
+}
+
+void NeoPixelEffectsCompositor::setBackground(CRGB color_crgb)
+{
+  _background = color_crgb;
+  _full = true;
+}
+
+void NeoPixelEffectsCompositor::invalidate()
+{
+  _full = true;
+}
+
+bool NeoPixelEffectsCompositor::update()
+{
+  return update(millis());
+}
+
+bool NeoPixelEffectsCompositor::update(unsigned long now)
+{
+  int first = 0;
+  int last = _numpix - 1;
+  bool dirty = _full;
+
+  for (int i = 0; i < _count; i++) {
+    Layer &layer = _layers[i];
+    if (layer.effect == NULL) {
+      continue;
+    }
+    layer.effect->update(now);
+
+    // Effect ranges are in layer pixels; move them to output pixels
+    int start, end;
+    if (layer.effect->getDirtyRange(start, end)) {
+      layer.effect->clearDirty();
+      start = max(start, 0) + layer.first;
+      end = min(end, layer.count - 1) + layer.first;
+      if (start > end || _full) {
+        continue;
+      }
+      if (!dirty || start < first) first = start;
+      if (!dirty || end > last) last = end;
+      dirty = true;
+    }
+  }
+
+  if (!dirty) {
+    return false;
+  }
+  compositeSpan(first, last);
+  _full = false;
+  return true;
+}
+
+void NeoPixelEffectsCompositor::compositeSpan(int first, int last)
+{
+  CRGB chunk[COMPOSITE_CHUNK];
+
+  for (int base = first; base <= last; base += COMPOSITE_CHUNK) {
+    int count = min(COMPOSITE_CHUNK, last - base + 1);
+    fillPixels(chunk, count, _background);
+
+    for (int i = 0; i < _count; i++) {
+      const Layer &layer = _layers[i];
+      if (!layer.visible || layer.alpha == 0) {
+        continue;
+      }
+      int start = max(base, layer.first);
+      int end = min(base + count, layer.first + layer.count);
+      if (start >= end) {
+        continue;
+      }
+      blendPixels(chunk + (start - base), layer.pixels + (start - layer.first), end - start, layer.mode, layer.alpha);
+    }
+
+    memcpy(_output + base, chunk, count * sizeof(CRGB));
+  }
+
+  if (_dirtyend < _dirtystart) {
+    _dirtystart = first;
+    _dirtyend = last;
+  } else {
+    _dirtystart = min(_dirtystart, first);
+    _dirtyend = max(_dirtyend, last);
+  }
+}
+
+bool NeoPixelEffectsCompositor::getDirtyRange(int &first, int &last)
+{
+  if (_dirtyend < _dirtystart) {
+    return false;
+  }
+  first = _dirtystart;
+  last = _dirtyend;
+  return true;
+}
+
+void NeoPixelEffectsCompositor::clearDirty()
+{
+  _dirtystart = 1;
+  _dirtyend = 0;
+}
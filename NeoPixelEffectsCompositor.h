@@ -0,0 +1,87 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSCOMPOSITOR_H
+#define NEOPIXELEFFECTSCOMPOSITOR_H
+
+#include <NeoPixelEffects.h>
+
+// Maximum number of layers a single compositor can blend
+#ifndef NEOPIXELEFFECTS_MAX_LAYERS
+ #define NEOPIXELEFFECTS_MAX_LAYERS 8
+#endif
+
+// How a layer is combined with the layers below it. The layer's alpha then
+// fades between the pixels below (0) and the blended result (255).
+enum BlendMode {
+  BLEND_NORMAL,     // The layer replaces what is below
+  BLEND_ADD,        // Channels are added, saturating at 255
+  BLEND_MAX,        // The brighter of each channel is kept
+  BLEND_MULTIPLY,   // Channels are multiplied, so the layer acts as a mask
+  BLEND_ALPHA,      // Like NORMAL, with each pixel's brightest channel as its opacity so black is transparent
+  NUM_BLENDMODE
+};
+
+// Blends effects drawn into separate layer buffers into one output buffer.
+// Each layer is an effect rendering into its own CRGB array, either as long
+// as the output or a tile placed at an offset in it. update() renders the
+// effects and recomposites only the pixels whose layers changed.
+class NeoPixelEffectsCompositor {
+  public:
+    NeoPixelEffectsCompositor(CRGB *output, int numpix);
+
+    // Layers are blended in the order they are added. pixels must hold
+    // numpix pixels, or for a tile count pixels shown from output pixel
+    // first on. effect draws into pixels and may be NULL for layers drawn
+    // by the sketch. Returns the layer index, or -1 when full.
+    int addLayer(NeoPixelEffects *effect, CRGB *pixels, BlendMode mode = BLEND_NORMAL, uint8_t alpha = 255);
+    int addTile(NeoPixelEffects *effect, CRGB *pixels, int first, int count, BlendMode mode = BLEND_NORMAL, uint8_t alpha = 255);
+    void removeAll();
+    int getCount();
+    void setLayerMode(int layer, BlendMode mode);
+    void setLayerAlpha(int layer, uint8_t alpha);
+    void setLayerVisible(int layer, bool visible);
+    void setBackground(CRGB color_crgb);   // Shown where no layer covers the output
+
+    bool update();  // Process all layer effects, returns true if output pixels changed
+    bool update(unsigned long now);
+    void invalidate();  // Recomposite every pixel on the next update, e.g. after drawing a layer by hand
+    bool getDirtyRange(int &first, int &last); // Output pixels written since clearDirty(), false if none
+    void clearDirty();
+
+  private:
+    struct Layer {
+      NeoPixelEffects *effect;
+      CRGB *pixels;
+      int first;
+      int count;
+      uint8_t mode;
+      uint8_t alpha;
+      bool visible;
+    };
+
+    void compositeSpan(int first, int last);
+
+    CRGB *_output;
+    int _numpix;
+    Layer _layers[NEOPIXELEFFECTS_MAX_LAYERS];
+    uint8_t _count;
+    CRGB _background;
+    bool _full;             // Every pixel needs compositing
+    int _dirtystart;
+    int _dirtyend;
+};
+
+#endif
@@ -0,0 +1,183 @@
+/*-------------------------------------------------------------------------
+  Lookup table brightness, gamma and white balance correction.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsCorrection.h>
+#include <math.h>
+
+NeoPixelEffectsCorrection::NeoPixelEffectsCorrection() :
+  _balance(255, 255, 255), _brightness(255), _limit(255), _frame(0), _dither(false), _valid(false)
+{
+  _gamma[0] = _gamma[1] = _gamma[2] = 1.0;
+}
+
+void NeoPixelEffectsCorrection::setBrightness(uint8_t brightness)
+{
+  if (brightness != _brightness) {
+    _brightness = brightness;
+    _valid = false;
+  }
+}
+
+uint8_t NeoPixelEffectsCorrection::getBrightness()
+{
+  return _brightness;
+}
+
+void NeoPixelEffectsCorrection::setLimit(uint8_t limit)
+{
+  _limit = limit;
+}
+
+uint8_t NeoPixelEffectsCorrection::getLimit()
+{
+  return _limit;
+}
+
+void NeoPixelEffectsCorrection::setGamma(float gamma)
+{
+  setGamma(gamma, gamma, gamma);
+}
+
+void NeoPixelEffectsCorrection::setGamma(float red, float green, float blue)
+{
+  _gamma[0] = red;
+  _gamma[1] = green;
+  _gamma[2] = blue;
+  _valid = false;
+}
+
+void NeoPixelEffectsCorrection::setWhiteBalance(CRGB balance)
+{
+  _balance = balance;
+  _valid = false;
+}
+
+#if NEOPIXELEFFECTS_DITHER
+void NeoPixelEffectsCorrection::setDither(bool dither)
+{
+  _dither = dither;
+}
+#endif
+
+void NeoPixelEffectsCorrection::rebuild()
+{
+  for (int c = 0; c < 3; c++) {
+    // Full scale for this channel in 1/256, after brightness and balance
+    float scale = 255.0 * 256.0 * (_brightness / 255.0) * (_balance.raw[c] / 255.0);
+    for (int v = 0; v < 256; v++) {
+      float level = (_gamma[c] == 1.0) ? v / 255.0 : pow(v / 255.0, _gamma[c]);
+      long value = (long)(level * scale + 0.5);
+#if NEOPIXELEFFECTS_DITHER
+      _table[c][v] = value;
+#else
+      _table[c][v] = (value + 128) >> 8;
+#endif
+    }
+  }
+  _valid = true;
+}
+
+uint8_t NeoPixelEffectsCorrection::correct(uint8_t value, int channel)
+{
+  if (!_valid) {
+    rebuild();
+  }
+#if NEOPIXELEFFECTS_DITHER
+  return min((_table[channel][value] + 128) >> 8, 255);
+#else
+  return _table[channel][value];
+#endif
+}
+
+void NeoPixelEffectsCorrection::apply(const CRGB *src, CRGB *dest, int count)
+{
+  if (!_valid) {
+    rebuild();
+  }
+  // The limit changes from frame to frame, so it scales the table values
+  // as they are read instead of rebuilding the tables
+  uint16_t limit = _limit + 1;
+
+#if NEOPIXELEFFECTS_DITHER
+  const uint16_t *red = _table[0];
+  const uint16_t *green = _table[1];
+  const uint16_t *blue = _table[2];
+
+  if (_dither) {
+    // The threshold steps through the frame counter with its bits reversed,
+    // so eight frames cover the fraction evenly, and is offset per pixel so
+    // neighbours do not flicker in step
+    uint8_t f = _frame++;
+    f = ((f & 0x01) << 7) | ((f & 0x02) << 5) | ((f & 0x04) << 3) | ((f & 0x08) << 1) |
+        ((f & 0x10) >> 1) | ((f & 0x20) >> 3) | ((f & 0x40) >> 5) | ((f & 0x80) >> 7);
+    uint8_t threshold = f;
+    for (int i = 0; i < count; i++) {
+      CRGB pixel = src[i];
+      if (limit < 256) {
+        dest[i].r = ((((uint32_t)red[pixel.r] * limit) >> 8) + threshold) >> 8;
+        dest[i].g = ((((uint32_t)green[pixel.g] * limit) >> 8) + threshold) >> 8;
+        dest[i].b = ((((uint32_t)blue[pixel.b] * limit) >> 8) + threshold) >> 8;
+      } else {
+        dest[i].r = (red[pixel.r] + threshold) >> 8;
+        dest[i].g = (green[pixel.g] + threshold) >> 8;
+        dest[i].b = (blue[pixel.b] + threshold) >> 8;
+      }
+      threshold += 97;
+    }
+    return;
+  }
+
+  if (limit < 256) {
+    // Round down, so a limited frame never draws more than the limit allows
+    for (int i = 0; i < count; i++) {
+      CRGB pixel = src[i];
+      dest[i].r = ((uint32_t)red[pixel.r] * limit) >> 16;
+      dest[i].g = ((uint32_t)green[pixel.g] * limit) >> 16;
+      dest[i].b = ((uint32_t)blue[pixel.b] * limit) >> 16;
+    }
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    CRGB pixel = src[i];
+    dest[i].r = (red[pixel.r] + 128) >> 8;
+    dest[i].g = (green[pixel.g] + 128) >> 8;
+    dest[i].b = (blue[pixel.b] + 128) >> 8;
+  }
+#else
+  const uint8_t *red = _table[0];
+  const uint8_t *green = _table[1];
+  const uint8_t *blue = _table[2];
+
+  if (limit < 256) {
+    for (int i = 0; i < count; i++) {
+      CRGB pixel = src[i];
+      dest[i].r = (red[pixel.r] * limit) >> 8;
+      dest[i].g = (green[pixel.g] * limit) >> 8;
+      dest[i].b = (blue[pixel.b] * limit) >> 8;
+    }
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    CRGB pixel = src[i];
+    dest[i].r = red[pixel.r];
+    dest[i].g = green[pixel.g];
+    dest[i].b = blue[pixel.b];
+  }
+#endif
+}
@@ -0,0 +1,72 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSCORRECTION_H
+#define NEOPIXELEFFECTSCORRECTION_H
+
+#include <NeoPixelEffects.h>
+
+// Keep 8 fractional bits per table entry for temporal dithering. Doubles
+// the tables to 1536 bytes, so it is off on AVR.
+#ifndef NEOPIXELEFFECTS_DITHER
+ #ifdef __AVR__
+  #define NEOPIXELEFFECTS_DITHER 0
+ #else
+  #define NEOPIXELEFFECTS_DITHER 1
+ #endif
+#endif
+
+// Brightness, gamma and white balance for a whole frame, applied as the
+// frame leaves the effects. All three are folded into one lookup table per
+// channel, rebuilt only after a setting changes, so a frame costs three
+// table reads per pixel however many corrections are set. Effects keep
+// drawing linear values, so apply() into a separate output buffer: FADE,
+// incremental scrolling and playback read back the pixels they drew.
+class NeoPixelEffectsCorrection {
+  public:
+    NeoPixelEffectsCorrection();
+
+    void setBrightness(uint8_t brightness);
+    uint8_t getBrightness();
+    void setLimit(uint8_t limit); // Further scale applied without rebuilding the tables, 255 for none
+    uint8_t getLimit();
+    void setGamma(float gamma);   // 1.0 is linear, 2.2 to 2.8 suits most LEDs
+    void setGamma(float red, float green, float blue);
+    void setWhiteBalance(CRGB balance); // Scale of each channel, e.g. CRGB(255, 176, 240) for typical strips
+#if NEOPIXELEFFECTS_DITHER
+    void setDither(bool dither);  // Spread the fraction lost to 8-bit output over the following frames
+#endif
+
+    void apply(const CRGB *src, CRGB *dest, int count); // Correct count pixels, once per frame
+    uint8_t correct(uint8_t value, int channel);        // One corrected channel value, without dithering
+
+  private:
+    void rebuild();
+
+#if NEOPIXELEFFECTS_DITHER
+    uint16_t _table[3][256];  // Corrected values in 1/256
+#else
+    uint8_t _table[3][256];
+#endif
+    float _gamma[3];
+    CRGB _balance;
+    uint8_t _brightness;
+    uint8_t _limit;
+    uint8_t _frame;           // Advances the dither pattern
+    bool _dither;
+    bool _valid;              // The tables match the settings
+};
+
+#endif
@@ -0,0 +1,258 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Bulk pixel kernels used by the effects. On x86 and ARM hosts they use
+// SSE2, AVX2 or NEON, picked at compile time from the target flags; every
+// other target, or any build defining NEOPIXELEFFECTS_NO_SIMD, gets the
+// portable version. All versions produce identical pixels.
+
+#ifndef NEOPIXELEFFECTSKERNELS_H
+#define NEOPIXELEFFECTSKERNELS_H
+
+#include <FastLED.h>
+#include <string.h>
+
+#if !defined(NEOPIXELEFFECTS_NO_SIMD)
+ #if defined(__AVX2__)
+  #include <immintrin.h>
+  #define NEOPIXELEFFECTS_SIMD_AVX2 1
+ #elif defined(__SSE2__)
+  #include <emmintrin.h>
+  #define NEOPIXELEFFECTS_SIMD_SSE2 1
+ #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define NEOPIXELEFFECTS_SIMD_NEON 1
+ #endif
+#endif
+
+// Converts a 0-100 effect counter into a 0.16 fixed point fraction. Rounding
+// up keeps (value * fraction) >> 16 equal to value * percent / 100 for all
+// 8-bit values, so no per-channel division is needed. The counters stay
+// 0-100 rather than 0-255 on purpose: PULSE, GLOW and FADE take one tick
+// per step, so their step count sets how long a cycle lasts, and render()
+// and the catch-up replay count ticks on the same scale. This conversion
+// runs once per frame, not per pixel.
+static inline uint32_t percentToFraction(int percent)
+{
+  return ((uint32_t)percent * 65536 + 99) / 100;
+}
+
+static inline void scaleColor(CRGB &color, uint32_t fraction)
+{
+  color.r = (color.r * fraction) >> 16;
+  color.g = (color.g * fraction) >> 16;
+  color.b = (color.b * fraction) >> 16;
+}
+
+// Sum of the three channels of a pixel
+static inline uint16_t pixelLoad(CRGB color)
+{
+  return color.r + color.g + color.b;
+}
+
+// Sum of the four bytes of a word, two at a time
+static inline uint16_t byteSum(uint32_t bits)
+{
+  bits = (bits & 0x00FF00FF) + ((bits >> 8) & 0x00FF00FF);
+  return (bits & 0xFFFF) + (bits >> 16);
+}
+
+// Sets count pixels to color
+static inline void fillPixels(CRGB *pix, int count, const CRGB &color)
+{
+  if (count <= 0) {
+    return;
+  }
+
+  int i = 0;
+  // Setting up the vectors costs more than a short run saves
+  if (count < 32) {
+    for (; i < count; i++) {
+      pix[i] = color;
+    }
+    return;
+  }
+#if defined(NEOPIXELEFFECTS_SIMD_AVX2)
+  // 32 pixels are exactly three 32-byte vectors
+  uint8_t pattern[96];
+  for (int j = 0; j < 96; j += 3) {
+    pattern[j] = color.r;
+    pattern[j + 1] = color.g;
+    pattern[j + 2] = color.b;
+  }
+  __m256i v0 = _mm256_loadu_si256((const __m256i *)pattern);
+  __m256i v1 = _mm256_loadu_si256((const __m256i *)(pattern + 32));
+  __m256i v2 = _mm256_loadu_si256((const __m256i *)(pattern + 64));
+  for (; i + 32 <= count; i += 32) {
+    uint8_t *dst = (uint8_t *)(pix + i);
+    _mm256_storeu_si256((__m256i *)dst, v0);
+    _mm256_storeu_si256((__m256i *)(dst + 32), v1);
+    _mm256_storeu_si256((__m256i *)(dst + 64), v2);
+  }
+#elif defined(NEOPIXELEFFECTS_SIMD_SSE2)
+  // 16 pixels are exactly three 16-byte vectors
+  uint8_t pattern[48];
+  for (int j = 0; j < 48; j += 3) {
+    pattern[j] = color.r;
+    pattern[j + 1] = color.g;
+    pattern[j + 2] = color.b;
+  }
+  __m128i v0 = _mm_loadu_si128((const __m128i *)pattern);
+  __m128i v1 = _mm_loadu_si128((const __m128i *)(pattern + 16));
+  __m128i v2 = _mm_loadu_si128((const __m128i *)(pattern + 32));
+  for (; i + 16 <= count; i += 16) {
+    uint8_t *dst = (uint8_t *)(pix + i);
+    _mm_storeu_si128((__m128i *)dst, v0);
+    _mm_storeu_si128((__m128i *)(dst + 16), v1);
+    _mm_storeu_si128((__m128i *)(dst + 32), v2);
+  }
+#elif defined(NEOPIXELEFFECTS_SIMD_NEON)
+  // vst3 interleaves the three channel vectors back into RGB order
+  uint8x16x3_t v;
+  v.val[0] = vdupq_n_u8(color.r);
+  v.val[1] = vdupq_n_u8(color.g);
+  v.val[2] = vdupq_n_u8(color.b);
+  for (; i + 16 <= count; i += 16) {
+    vst3q_u8((uint8_t *)(pix + i), v);
+  }
+#else
+  // Double the filled run with memcpy, which is faster than a pixel loop
+  pix[0] = color;
+  i = 1;
+  while (i < count) {
+    int n = (i < count - i) ? i : count - i;
+    memcpy(pix + i, pix, n * sizeof(CRGB));
+    i += n;
+  }
+#endif
+  for (; i < count; i++) {
+    pix[i] = color;
+  }
+}
+
+// Scales every channel of count pixels to (value * fraction) >> 16 and
+// returns the sum of the scaled channels, as sumPixels() would after it
+static inline uint32_t scalePixels(CRGB *pix, int count, uint16_t fraction)
+{
+  uint8_t *bytes = (uint8_t *)pix;
+  long total = (long)count * sizeof(CRGB);
+  long i = 0;
+  uint32_t sum = 0;
+
+#if defined(NEOPIXELEFFECTS_SIMD_AVX2)
+  // Unpacking and packing both work per 128-bit lane, so byte order is kept
+  __m256i zero = _mm256_setzero_si256();
+  __m256i f = _mm256_set1_epi16((short)fraction);
+  __m256i acc = zero;
+  for (; i + 32 <= total; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(bytes + i));
+    __m256i lo = _mm256_mulhi_epu16(_mm256_unpacklo_epi8(v, zero), f);
+    __m256i hi = _mm256_mulhi_epu16(_mm256_unpackhi_epi8(v, zero), f);
+    __m256i scaled = _mm256_packus_epi16(lo, hi);
+    _mm256_storeu_si256((__m256i *)(bytes + i), scaled);
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(scaled, zero));
+  }
+  __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  sum = _mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+#elif defined(NEOPIXELEFFECTS_SIMD_SSE2)
+  __m128i zero = _mm_setzero_si128();
+  __m128i f = _mm_set1_epi16((short)fraction);
+  __m128i acc = zero;
+  for (; i + 16 <= total; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(bytes + i));
+    __m128i lo = _mm_mulhi_epu16(_mm_unpacklo_epi8(v, zero), f);
+    __m128i hi = _mm_mulhi_epu16(_mm_unpackhi_epi8(v, zero), f);
+    __m128i scaled = _mm_packus_epi16(lo, hi);
+    _mm_storeu_si128((__m128i *)(bytes + i), scaled);
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(scaled, zero));
+  }
+  sum = _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#elif defined(NEOPIXELEFFECTS_SIMD_NEON)
+  uint16x4_t f = vdup_n_u16(fraction);
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (; i + 16 <= total; i += 16) {
+    uint8x16_t v = vld1q_u8(bytes + i);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+    uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+    uint16x8_t slo = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(lo), f), 16),
+                                  vshrn_n_u32(vmull_u16(vget_high_u16(lo), f), 16));
+    uint16x8_t shi = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(hi), f), 16),
+                                  vshrn_n_u32(vmull_u16(vget_high_u16(hi), f), 16));
+    vst1q_u8(bytes + i, vcombine_u8(vmovn_u16(slo), vmovn_u16(shi)));
+    acc = vpadalq_u16(acc, vaddq_u16(slo, shi));
+  }
+  sum = vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#endif
+  for (; i < total; i++) {
+    bytes[i] = ((uint32_t)bytes[i] * fraction) >> 16;
+    sum += bytes[i];
+  }
+  return sum;
+}
+
+// Sum of every channel of count pixels
+static inline uint32_t sumPixels(const CRGB *pix, int count)
+{
+  const uint8_t *bytes = (const uint8_t *)pix;
+  long total = (long)count * sizeof(CRGB);
+  long i = 0;
+  uint32_t sum = 0;
+
+#if defined(NEOPIXELEFFECTS_SIMD_AVX2)
+  // sad against zero adds each group of eight bytes into a 64-bit lane
+  __m256i zero = _mm256_setzero_si256();
+  __m256i acc = zero;
+  for (; i + 32 <= total; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(bytes + i));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(v, zero));
+  }
+  __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  sum = _mm_cvtsi128_si32(half) + _mm_cvtsi128_si32(_mm_srli_si128(half, 8));
+#elif defined(NEOPIXELEFFECTS_SIMD_SSE2)
+  __m128i zero = _mm_setzero_si128();
+  __m128i acc = zero;
+  for (; i + 16 <= total; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(bytes + i));
+    acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+  }
+  sum = _mm_cvtsi128_si32(acc) + _mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+#elif defined(NEOPIXELEFFECTS_SIMD_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (; i + 16 <= total; i += 16) {
+    acc = vpadalq_u16(acc, vpaddlq_u8(vld1q_u8(bytes + i)));
+  }
+  sum = vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#endif
+  for (; i < total; i++) {
+    sum += bytes[i];
+  }
+  return sum;
+}
+
+// Moves count pixels one place, dropping the first (towardstart) or the
+// last one; the pixel left behind at the other end keeps its old value
+static inline void shiftPixels(CRGB *pix, int count, bool towardstart)
+{
+  if (count <= 1) {
+    return;
+  }
+  if (towardstart) {
+    memmove(pix, pix + 1, (count - 1) * sizeof(CRGB));
+  } else {
+    memmove(pix + 1, pix, (count - 1) * sizeof(CRGB));
+  }
+}
+
+#endif
@@ -0,0 +1,238 @@
+/*-------------------------------------------------------------------------
+  Drives a group of NeoPixelEffects from a single clock read per tick and
+  reports whether any of them rendered, so the sketch only pushes a frame
+  to the strip when something actually changed.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsManager.h>
+
+NeoPixelEffectsManager::NeoPixelEffectsManager() :
+  _count(0)
+{
+}
+
+bool NeoPixelEffectsManager::add(NeoPixelEffects *effect)
+{
+  if (effect == NULL || _count >= NEOPIXELEFFECTS_MAX_MANAGED) {
+    return false;
+  }
+  for (int i = 0; i < _count; i++) {
+    if (_effects[i] == effect) {
+      return true;
+    }
+  }
+  _effects[_count++] = effect;
+  return true;
+}
+
+bool NeoPixelEffectsManager::add(NeoPixelEffects *effects, int count)
+{
+  for (int i = 0; i < count; i++) {
+    if (!add(&effects[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void NeoPixelEffectsManager::remove(NeoPixelEffects *effect)
+{
+  for (int i = 0; i < _count; i++) {
+    if (_effects[i] == effect) {
+      _count--;
+      for (int j = i; j < _count; j++) {
+        _effects[j] = _effects[j + 1];
+      }
+      return;
+    }
+  }
+}
+
+void NeoPixelEffectsManager::removeAll()
+{
+  _count = 0;
+}
+
+int NeoPixelEffectsManager::getCount()
+{
+  return _count;
+}
+
+NeoPixelEffects *NeoPixelEffectsManager::getEffect(int index)
+{
+  if (index < 0 || index >= _count) {
+    return NULL;
+  }
+  return _effects[index];
+}
+
+bool NeoPixelEffectsManager::update()
+{
+  return update(millis());
+}
+
+bool NeoPixelEffectsManager::update(unsigned long now)
+{
+  bool changed = false;
+  for (int i = 0; i < _count; i++) {
+    if (_effects[i]->update(now)) {
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+unsigned long NeoPixelEffectsManager::getLateFrames()
+{
+  unsigned long late = 0;
+  for (int i = 0; i < _count; i++) {
+    late += _effects[i]->getLateFrames();
+  }
+  return late;
+}
+
+bool NeoPixelEffectsManager::getNextUpdate(unsigned long &when)
+{
+  return getNextUpdate(when, millis());
+}
+
+bool NeoPixelEffectsManager::getNextUpdate(unsigned long &when, unsigned long now)
+{
+  bool scheduled = false;
+  for (int i = 0; i < _count; i++) {
+    unsigned long due;
+    if (_effects[i]->getNextUpdate(due, now)) {
+      if (!scheduled || due - now < when - now) {
+        when = due;
+      }
+      scheduled = true;
+    }
+  }
+  return scheduled;
+}
+
+bool NeoPixelEffectsManager::getDirtyRange(int &first, int &last)
+{
+  bool dirty = false;
+  for (int i = 0; i < _count; i++) {
+    int start, end;
+    if (_effects[i]->getDirtyRange(start, end)) {
+      if (!dirty || start < first) first = start;
+      if (!dirty || end > last) last = end;
+      dirty = true;
+    }
+  }
+  return dirty;
+}
+
+int NeoPixelEffectsManager::writeDirtySpans(DirtySpanOutput output)
+{
+  int firsts[NEOPIXELEFFECTS_MAX_MANAGED];
+  int lasts[NEOPIXELEFFECTS_MAX_MANAGED];
+  int count = 0;
+
+  // Insertion sort the dirty ranges by first pixel
+  for (int i = 0; i < _count; i++) {
+    int first, last;
+    if (!_effects[i]->getDirtyRange(first, last)) {
+      continue;
+    }
+    int j = count++;
+    while (j > 0 && firsts[j - 1] > first) {
+      firsts[j] = firsts[j - 1];
+      lasts[j] = lasts[j - 1];
+      j--;
+    }
+    firsts[j] = first;
+    lasts[j] = last;
+  }
+
+  // Join ranges that overlap or touch so each pixel is sent once
+  int spans = 0;
+  int i = 0;
+  while (i < count) {
+    int first = firsts[i];
+    int last = lasts[i];
+    for (i++; i < count && firsts[i] <= last + 1; i++) {
+      if (lasts[i] > last) last = lasts[i];
+    }
+    output(first, last);
+    spans++;
+  }
+
+  clearDirty();
+  return spans;
+}
+
+void NeoPixelEffectsManager::clearDirty()
+{
+  for (int i = 0; i < _count; i++) {
+    _effects[i]->clearDirty();
+  }
+}
+
+#if NEOPIXELEFFECTS_STATS
+void NeoPixelEffectsManager::getStats(NeoPixelEffectsStats &total)
+{
+  total.reset();
+  for (int i = 0; i < _count; i++) {
+    total.add(_effects[i]->getStats());
+  }
+}
+
+void NeoPixelEffectsManager::resetStats()
+{
+  for (int i = 0; i < _count; i++) {
+    _effects[i]->resetStats();
+  }
+}
+
+void NeoPixelEffectsManager::printStats(Print &out)
+{
+  out.println(F("segment,effect,pixels,calls,frames,late frames,missed ticks,us total,us mean,us max,jitter ms mean,jitter ms max"));
+
+  for (int i = 0; i < _count; i++) {
+    out.print(i);
+    out.print(',');
+    _effects[i]->printStats(out);
+  }
+
+  NeoPixelEffectsStats total;
+  getStats(total);
+  out.print(F("total,,,"));
+  total.print(out);
+}
+#endif
+
+#if NEOPIXELEFFECTS_POWER
+uint32_t NeoPixelEffectsManager::getLoad()
+{
+  uint32_t load = 0;
+  for (int i = 0; i < _count; i++) {
+    load += _effects[i]->getLoad();
+  }
+  return load;
+}
+
+unsigned long NeoPixelEffectsManager::getCurrent()
+{
+  unsigned long current = 0;
+  for (int i = 0; i < _count; i++) {
+    current += _effects[i]->getCurrent();
+  }
+  return current;
+}
+#endif
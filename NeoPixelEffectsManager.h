@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSMANAGER_H
+#define NEOPIXELEFFECTSMANAGER_H
+
+#include <NeoPixelEffects.h>
+
+// Maximum number of effects a single manager can drive
+#ifndef NEOPIXELEFFECTS_MAX_MANAGED
+ #ifdef __AVR__
+  #define NEOPIXELEFFECTS_MAX_MANAGED 16
+ #else
+  #define NEOPIXELEFFECTS_MAX_MANAGED 64
+ #endif
+#endif
+
+// Receives one span of changed pixels, first to last inclusive
+typedef void (*DirtySpanOutput)(int first, int last);
+
+class NeoPixelEffectsManager {
+  public:
+    NeoPixelEffectsManager();
+
+    bool add(NeoPixelEffects *effect);              // Register an effect, returns false when full
+    bool add(NeoPixelEffects *effects, int count);  // Register an array of effects
+    void remove(NeoPixelEffects *effect);
+    void removeAll();
+    int getCount();
+    NeoPixelEffects *getEffect(int index);
+
+    bool update();  // Process all effects, returns true if any pixels changed
+    bool update(unsigned long now);
+    unsigned long getLateFrames();  // Sum of missed ticks over all effects
+    bool getNextUpdate(unsigned long &when); // Earliest time any effect is due, false if none is scheduled
+    bool getNextUpdate(unsigned long &when, unsigned long now);
+    bool getDirtyRange(int &first, int &last);  // Span covering every changed pixel, false if none
+    int writeDirtySpans(DirtySpanOutput output); // Pass each changed span to output in pixel order, then clear them
+    void clearDirty();
+#if NEOPIXELEFFECTS_STATS
+    void getStats(NeoPixelEffectsStats &total);  // Counters of every effect added together
+    void resetStats();
+    void printStats(Print &out);  // A CSV table with a row per effect and a total
+#endif
+#if NEOPIXELEFFECTS_POWER
+    uint32_t getLoad();           // Channel sum of every effect, assuming their ranges do not overlap
+    unsigned long getCurrent();   // Estimated draw of every effect's range, in mA
+#endif
+
+  private:
+    NeoPixelEffects *_effects[NEOPIXELEFFECTS_MAX_MANAGED];
+    uint8_t _count;
+};
+
+#endif
@@ -0,0 +1,125 @@
+/*-------------------------------------------------------------------------
+  Index tables from the logical pixel order to the physical LED order.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsMap.h>
+#include <math.h>
+
+NeoPixelEffectsMap::NeoPixelEffectsMap(const uint16_t *table, int count, bool progmem) :
+  _table(table), _count(count), _progmem(progmem)
+{
+}
+
+int NeoPixelEffectsMap::getCount()
+{
+  return _count;
+}
+
+uint16_t NeoPixelEffectsMap::getIndex(int logical)
+{
+  if (logical < 0 || logical >= _count) {
+    return NEOPIXELEFFECTS_NO_PIXEL;
+  }
+#ifdef __AVR__
+  if (_progmem) {
+    return pgm_read_word(_table + logical);
+  }
+#endif
+  return _table[logical];
+}
+
+void NeoPixelEffectsMap::apply(const CRGB *logical, CRGB *leds)
+{
+  apply(logical, leds, 0, _count - 1);
+}
+
+void NeoPixelEffectsMap::apply(const CRGB *logical, CRGB *leds, int first, int last)
+{
+  first = max(first, 0);
+  last = min(last, _count - 1);
+
+#ifdef __AVR__
+  if (_progmem) {
+    for (int i = first; i <= last; i++) {
+      uint16_t index = pgm_read_word(_table + i);
+      if (index != NEOPIXELEFFECTS_NO_PIXEL) {
+        leds[index] = logical[i];
+      }
+    }
+    return;
+  }
+#endif
+  const uint16_t *table = _table;
+  for (int i = first; i <= last; i++) {
+    uint16_t index = table[i];
+    if (index != NEOPIXELEFFECTS_NO_PIXEL) {
+      leds[index] = logical[i];
+    }
+  }
+}
+
+void NeoPixelEffectsMap::serpentine(uint16_t *table, int width, int height, bool vertical)
+{
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      uint16_t index;
+      if (vertical) {
+        index = x * height + ((x & 1) ? height - 1 - y : y);
+      } else {
+        index = y * width + ((y & 1) ? width - 1 - x : x);
+      }
+      table[y * width + x] = index;
+    }
+  }
+}
+
+void NeoPixelEffectsMap::matrixPhases(uint8_t *phases, int width, int height, PhasePattern pattern)
+{
+  // Centre and furthest distance from it, in half pixels so even sizes
+  // centre between two pixels
+  int cx = width - 1;
+  int cy = height - 1;
+  float furthest = sqrt((float)cx * cx + (float)cy * cy);
+  if (furthest == 0) {
+    furthest = 1;
+  }
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      long phase;
+      int dx = 2 * x - cx;
+      int dy = 2 * y - cy;
+      switch (pattern) {
+        case PHASE_VERTICAL:
+          phase = 255L * y / height;
+          break;
+        case PHASE_DIAGONAL:
+          phase = 255L * (x + y) / (width + height - 1);
+          break;
+        case PHASE_RADIAL:
+          phase = (long)(255 * sqrt((float)dx * dx + (float)dy * dy) / furthest);
+          break;
+        case PHASE_ANGULAR:
+          phase = (long)((atan2((float)dy, (float)dx) + M_PI) * 256 / (2 * M_PI));
+          break;
+        default:
+          phase = 255L * x / width;
+          break;
+      }
+      phases[y * width + x] = phase;
+    }
+  }
+}
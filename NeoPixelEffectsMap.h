@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSMAP_H
+#define NEOPIXELEFFECTSMAP_H
+
+#include <NeoPixelEffects.h>
+
+// Table entry for a logical position with no LED behind it
+#define NEOPIXELEFFECTS_NO_PIXEL 0xFFFF
+
+// How matrixPhases() lays a wave or rainbow over a matrix
+enum PhasePattern {
+  PHASE_HORIZONTAL,   // Moves along the rows
+  PHASE_VERTICAL,     // Moves along the columns
+  PHASE_DIAGONAL,     // Moves from one corner to the opposite one
+  PHASE_RADIAL,       // Rings spreading from the centre
+  PHASE_ANGULAR,      // Turns around the centre, for rings and spirals
+  NUM_PHASEPATTERN
+};
+
+// Connects the logical order effects draw in to the order the LEDs are
+// wired in. Effects draw into a logical buffer as if it were a straight
+// strip; apply() then copies each logical pixel to the LED the table
+// names, one table read per pixel. The table can be built at startup, e.g.
+// with serpentine(), or kept in PROGMEM on AVR.
+class NeoPixelEffectsMap {
+  public:
+    NeoPixelEffectsMap(const uint16_t *table, int count, bool progmem = false); // table[logical] is the LED index
+
+    int getCount();
+    uint16_t getIndex(int logical);   // LED index, NEOPIXELEFFECTS_NO_PIXEL if none
+    void apply(const CRGB *logical, CRGB *leds);  // Copy every logical pixel to its LED
+    void apply(const CRGB *logical, CRGB *leds, int first, int last); // Only logical pixels first to last, e.g. a dirty range
+
+    // Rows of width LEDs wired back and forth, the first from the left; or
+    // columns of height LEDs if vertical
+    static void serpentine(uint16_t *table, int width, int height, bool vertical = false);
+    // Phase of each position of a width x height matrix in row order, for a
+    // NeoPixelEffectsCache with keepphases set
+    static void matrixPhases(uint8_t *phases, int width, int height, PhasePattern pattern);
+
+  private:
+    const uint16_t *_table;
+    int _count;
+    bool _progmem;
+};
+
+#endif
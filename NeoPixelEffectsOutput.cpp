@@ -0,0 +1,272 @@
+/*-------------------------------------------------------------------------
+  Asynchronous frame output for hosts that send frames to a file, pipe or
+  network socket instead of driving LEDs directly.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsOutput.h>
+
+#ifdef NEOPIXELEFFECTS_HAS_THREADS
+
+#include <string.h>
+
+#ifdef NEOPIXELEFFECTS_HAS_SOCKETS
+ #include <arpa/inet.h>
+ #include <netinet/in.h>
+ #include <sys/socket.h>
+ #include <unistd.h>
+#endif
+
+NeoPixelEffectsFileSink::NeoPixelEffectsFileSink(FILE *file) :
+  _file(file)
+{
+}
+
+bool NeoPixelEffectsFileSink::write(const CRGB *pixels, int numpix)
+{
+  if (_file == NULL) {
+    return false;
+  }
+  size_t written = fwrite(pixels, sizeof(CRGB), numpix, _file);
+  return fflush(_file) == 0 && written == (size_t)numpix;
+}
+
+#ifdef NEOPIXELEFFECTS_HAS_SOCKETS
+NeoPixelEffectsUdpSink::NeoPixelEffectsUdpSink(const char *address, uint16_t port) :
+  _address(0), _port(htons(port))
+{
+  _socket = socket(AF_INET, SOCK_DGRAM, 0);
+  struct in_addr addr;
+  if (inet_pton(AF_INET, address, &addr) == 1) {
+    _address = addr.s_addr;
+  } else if (_socket >= 0) {
+    close(_socket);
+    _socket = -1;
+  }
+}
+
+NeoPixelEffectsUdpSink::~NeoPixelEffectsUdpSink()
+{
+  if (_socket >= 0) {
+    close(_socket);
+  }
+}
+
+bool NeoPixelEffectsUdpSink::write(const CRGB *pixels, int numpix)
+{
+  if (_socket < 0) {
+    return false;
+  }
+
+  struct sockaddr_in dest;
+  memset(&dest, 0, sizeof(dest));
+  dest.sin_family = AF_INET;
+  dest.sin_port = _port;
+  dest.sin_addr.s_addr = _address;
+
+  uint8_t packet[4 + NEOPIXELEFFECTS_UDP_PIXELS * sizeof(CRGB)];
+  bool ok = true;
+  for (int first = 0; first < numpix; first += NEOPIXELEFFECTS_UDP_PIXELS) {
+    int count = min(numpix - first, NEOPIXELEFFECTS_UDP_PIXELS);
+    packet[0] = first & 0xFF;
+    packet[1] = first >> 8;
+    packet[2] = count & 0xFF;
+    packet[3] = count >> 8;
+    memcpy(packet + 4, pixels + first, count * sizeof(CRGB));
+    size_t length = 4 + count * sizeof(CRGB);
+    if (sendto(_socket, packet, length, 0, (struct sockaddr *)&dest, sizeof(dest)) != (ssize_t)length) {
+      ok = false;
+    }
+  }
+  return ok;
+}
+#endif
+
+NeoPixelEffectsOutput::NeoPixelEffectsOutput(const CRGB *pixels, int numpix, NeoPixelEffectsSink &sink, int buffers) :
+  _source(pixels), _correction(NULL), _numpix(numpix), _sink(sink), _sequence(0), _quit(false),
+  _frames(0), _dropped(0), _errors(0), _latency(0), _maxlatency(0), _totallatency(0)
+{
+  _buffercount = constrain(buffers, 2, NEOPIXELEFFECTS_MAX_OUTPUT_BUFFERS);
+  for (int i = 0; i < _buffercount; i++) {
+    _slots[i].pixels = new CRGB[_numpix];
+    _slots[i].state = SLOT_FREE;
+    _slots[i].sequence = 0;
+  }
+  _thread = std::thread(&NeoPixelEffectsOutput::outputLoop, this);
+}
+
+NeoPixelEffectsOutput::~NeoPixelEffectsOutput()
+{
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _quit = true;
+  }
+  _ready.notify_all();
+  _thread.join();
+  for (int i = 0; i < _buffercount; i++) {
+    delete[] _slots[i].pixels;
+  }
+}
+
+bool NeoPixelEffectsOutput::submit()
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  Slot *slot = NULL;
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    for (int i = 0; i < _buffercount; i++) {
+      if (_slots[i].state == SLOT_FREE) {
+        slot = &_slots[i];
+        break;
+      }
+    }
+    if (slot == NULL) {
+      // Double buffered with one frame on the wire and one waiting
+      _dropped++;
+      return false;
+    }
+    slot->state = SLOT_FILLING;
+  }
+
+  // The output thread never touches a filling slot, so copy without the lock
+  if (_correction != NULL) {
+    _correction->apply(_source, slot->pixels, _numpix);
+  } else {
+    memcpy(slot->pixels, _source, _numpix * sizeof(CRGB));
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    for (int i = 0; i < _buffercount; i++) {
+      if (_slots[i].state == SLOT_PENDING) {
+        // Not sent yet and already out of date
+        _slots[i].state = SLOT_FREE;
+        _dropped++;
+      }
+    }
+    slot->state = SLOT_PENDING;
+    slot->sequence = ++_sequence;
+    slot->submitted = now;
+  }
+  _ready.notify_one();
+  return true;
+}
+
+void NeoPixelEffectsOutput::flush()
+{
+  std::unique_lock<std::mutex> guard(_lock);
+  _idle.wait(guard, [this] {
+    for (int i = 0; i < _buffercount; i++) {
+      if (_slots[i].state == SLOT_PENDING || _slots[i].state == SLOT_WRITING) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+void NeoPixelEffectsOutput::setCorrection(NeoPixelEffectsCorrection *correction)
+{
+  _correction = correction;
+}
+
+void NeoPixelEffectsOutput::outputLoop()
+{
+  while (true) {
+    Slot *slot = NULL;
+    {
+      std::unique_lock<std::mutex> guard(_lock);
+      _ready.wait(guard, [this, &slot] {
+        for (int i = 0; i < _buffercount; i++) {
+          if (_slots[i].state == SLOT_PENDING) {
+            slot = &_slots[i];
+            return true;
+          }
+        }
+        return _quit;
+      });
+      if (slot == NULL) {
+        return;
+      }
+      slot->state = SLOT_WRITING;
+    }
+
+    bool ok = _sink.write(slot->pixels, _numpix);
+    unsigned long latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - slot->submitted).count();
+
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      slot->state = SLOT_FREE;
+      _frames++;
+      if (!ok) {
+        _errors++;
+      }
+      _latency = latency;
+      _maxlatency = max(_maxlatency, latency);
+      _totallatency += latency;
+    }
+    _idle.notify_all();
+  }
+}
+
+unsigned long NeoPixelEffectsOutput::getFrames()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _frames;
+}
+
+unsigned long NeoPixelEffectsOutput::getDroppedFrames()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _dropped;
+}
+
+unsigned long NeoPixelEffectsOutput::getWriteErrors()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _errors;
+}
+
+unsigned long NeoPixelEffectsOutput::getLatency()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _latency;
+}
+
+unsigned long NeoPixelEffectsOutput::getMaxLatency()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return _maxlatency;
+}
+
+unsigned long NeoPixelEffectsOutput::getAverageLatency()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  return (_frames > 0) ? (unsigned long)(_totallatency / _frames) : 0;
+}
+
+void NeoPixelEffectsOutput::resetStats()
+{
+  std::lock_guard<std::mutex> guard(_lock);
+  _frames = 0;
+  _dropped = 0;
+  _errors = 0;
+  _latency = 0;
+  _maxlatency = 0;
+  _totallatency = 0;
+}
+
+#endif
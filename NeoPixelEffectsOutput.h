@@ -0,0 +1,138 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSOUTPUT_H
+#define NEOPIXELEFFECTSOUTPUT_H
+
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsCorrection.h>
+
+#ifdef NEOPIXELEFFECTS_HAS_THREADS
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+
+#if defined(__has_include)
+ #if __has_include(<sys/socket.h>) && __has_include(<netinet/in.h>)
+  #define NEOPIXELEFFECTS_HAS_SOCKETS 1
+ #endif
+#endif
+
+// Most frame buffers an output stage can cycle through
+#define NEOPIXELEFFECTS_MAX_OUTPUT_BUFFERS 3
+
+// Where finished frames are sent. write() runs on the output thread and
+// may block for as long as the device needs.
+class NeoPixelEffectsSink {
+  public:
+    virtual ~NeoPixelEffectsSink() {}
+    virtual bool write(const CRGB *pixels, int numpix) = 0;  // Returns false on an I/O error
+};
+
+// Writes each frame as raw RGB bytes to a file, pipe or FIFO opened by the
+// sketch, and flushes it so a reader sees whole frames
+class NeoPixelEffectsFileSink : public NeoPixelEffectsSink {
+  public:
+    NeoPixelEffectsFileSink(FILE *file);
+    bool write(const CRGB *pixels, int numpix);
+
+  private:
+    FILE *_file;
+};
+
+#ifdef NEOPIXELEFFECTS_HAS_SOCKETS
+// Sends each frame to a UDP port, split into datagrams of at most
+// NEOPIXELEFFECTS_UDP_PIXELS pixels. Each datagram starts with the first
+// pixel and the pixel count as 16-bit little endian values, followed by
+// the RGB bytes, as in the DirtySpans example.
+#define NEOPIXELEFFECTS_UDP_PIXELS 480
+
+class NeoPixelEffectsUdpSink : public NeoPixelEffectsSink {
+  public:
+    NeoPixelEffectsUdpSink(const char *address, uint16_t port); // IPv4 address, e.g. "127.0.0.1"
+    ~NeoPixelEffectsUdpSink();
+    bool write(const CRGB *pixels, int numpix);
+
+  private:
+    int _socket;
+    uint32_t _address;
+    uint16_t _port;
+};
+#endif
+
+// Sends frames to a sink from a dedicated thread, so the render loop does
+// not wait while a frame is serialized and written. submit() copies the
+// finished frame into a free buffer and returns; the pixels keep their
+// contents, so effects that build on the previous frame carry on as usual.
+// With three buffers the newest frame replaces one still waiting to be
+// sent; with two, a frame submitted while both are busy is dropped.
+// A correction set with setCorrection() is applied while the frame is
+// copied, so it costs no extra pass.
+class NeoPixelEffectsOutput {
+  public:
+    NeoPixelEffectsOutput(const CRGB *pixels, int numpix, NeoPixelEffectsSink &sink, int buffers = 3);
+    ~NeoPixelEffectsOutput();
+
+    bool submit();  // Queue the current frame, false if it was dropped
+    void flush();   // Wait until every queued frame has been written
+    void setCorrection(NeoPixelEffectsCorrection *correction);  // NULL sends frames unchanged
+
+    unsigned long getFrames();          // Frames written to the sink
+    unsigned long getDroppedFrames();   // Frames replaced or refused before they were written
+    unsigned long getWriteErrors();
+    unsigned long getLatency();         // Microseconds from submit() to the end of the write, last frame
+    unsigned long getMaxLatency();
+    unsigned long getAverageLatency();
+    void resetStats();
+
+  private:
+    enum SlotState { SLOT_FREE, SLOT_FILLING, SLOT_PENDING, SLOT_WRITING };
+
+    struct Slot {
+      CRGB *pixels;
+      SlotState state;
+      unsigned long sequence;             // Order frames were submitted in
+      std::chrono::steady_clock::time_point submitted;
+    };
+
+    void outputLoop();
+
+    const CRGB *_source;
+    NeoPixelEffectsCorrection *_correction;
+    int _numpix;
+    NeoPixelEffectsSink &_sink;
+    int _buffercount;
+    Slot _slots[NEOPIXELEFFECTS_MAX_OUTPUT_BUFFERS];
+    unsigned long _sequence;
+    std::mutex _lock;
+    std::condition_variable _ready;     // A frame is pending or the thread should quit
+    std::condition_variable _idle;      // A frame was written
+    std::thread _thread;
+    bool _quit;
+
+    unsigned long _frames;
+    unsigned long _dropped;
+    unsigned long _errors;
+    unsigned long _latency;
+    unsigned long _maxlatency;
+    unsigned long long _totallatency;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,150 @@
+/*-------------------------------------------------------------------------
+  Multi-threaded rendering of many NeoPixelEffects segments for hosts with
+  several cores, such as a Linux board driving a large LED wall.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsParallel.h>
+
+#ifdef NEOPIXELEFFECTS_HAS_THREADS
+
+NeoPixelEffectsParallel::NeoPixelEffectsParallel(NeoPixelEffectsManager &manager, unsigned int threads) :
+  _manager(&manager), _effects(NULL), _count(0), _generation(0), _pending(0), _quit(false), _now(0), _changed(false)
+{
+  startThreads(threads);
+}
+
+NeoPixelEffectsParallel::NeoPixelEffectsParallel(NeoPixelEffects *effects, int count, unsigned int threads) :
+  _manager(NULL), _effects(effects), _count((effects != NULL && count > 0) ? count : 0),
+  _generation(0), _pending(0), _quit(false), _now(0), _changed(false)
+{
+  startThreads(threads);
+}
+
+void NeoPixelEffectsParallel::startThreads(unsigned int threads)
+{
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  _threadcount = (threads > 0) ? threads : 1;
+
+  _slices = new Slice[_threadcount];
+  for (unsigned int i = 0; i < _threadcount; i++) {
+    _slices[i].next = 0;
+    _slices[i].end = 0;
+  }
+
+  // The calling thread works as thread 0
+  _threads = new std::thread[_threadcount];
+  for (unsigned int i = 1; i < _threadcount; i++) {
+    _threads[i] = std::thread(&NeoPixelEffectsParallel::workerLoop, this, i);
+  }
+}
+
+NeoPixelEffectsParallel::~NeoPixelEffectsParallel()
+{
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _quit = true;
+  }
+  _start.notify_all();
+  for (unsigned int i = 1; i < _threadcount; i++) {
+    _threads[i].join();
+  }
+  delete[] _threads;
+  delete[] _slices;
+}
+
+unsigned int NeoPixelEffectsParallel::getThreadCount()
+{
+  return _threadcount;
+}
+
+bool NeoPixelEffectsParallel::update()
+{
+  return update(millis());
+}
+
+bool NeoPixelEffectsParallel::update(unsigned long now)
+{
+  int count = (_manager != NULL) ? _manager->getCount() : _count;
+  for (unsigned int i = 0; i < _threadcount; i++) {
+    _slices[i].next = (int)((long)count * i / _threadcount);
+    _slices[i].end = (int)((long)count * (i + 1) / _threadcount);
+  }
+  _changed = false;
+
+  {
+    std::lock_guard<std::mutex> guard(_lock);
+    _now = now;
+    _pending = _threadcount - 1;
+    _generation++;
+  }
+  _start.notify_all();
+
+  runSlices(0);
+
+  {
+    std::unique_lock<std::mutex> guard(_lock);
+    _done.wait(guard, [this] { return _pending == 0; });
+  }
+
+  return _changed;
+}
+
+void NeoPixelEffectsParallel::workerLoop(unsigned int id)
+{
+  unsigned long seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> guard(_lock);
+      _start.wait(guard, [this, seen] { return _quit || _generation != seen; });
+      if (_quit) {
+        return;
+      }
+      seen = _generation;
+    }
+
+    runSlices(id);
+
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _pending--;
+      if (_pending == 0) {
+        _done.notify_one();
+      }
+    }
+  }
+}
+
+void NeoPixelEffectsParallel::runSlices(unsigned int id)
+{
+  // Drain our own slice first, then take what is left of the others
+  for (unsigned int n = 0; n < _threadcount; n++) {
+    Slice &slice = _slices[(id + n) % _threadcount];
+    while (true) {
+      int i = slice.next.fetch_add(1);
+      if (i >= slice.end) {
+        break;
+      }
+      NeoPixelEffects *effect = (_manager != NULL) ? _manager->getEffect(i) : &_effects[i];
+      if (effect->update(_now)) {
+        _changed = true;
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSPARALLEL_H
+#define NEOPIXELEFFECTSPARALLEL_H
+
+#include <NeoPixelEffectsManager.h>
+
+#ifdef NEOPIXELEFFECTS_HAS_THREADS
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Renders the effects registered with a manager, or a plain array of effects
+// of any length, on a pool of worker threads.
+// Each worker starts on its own slice of the effect list and, once that is
+// done, takes the remaining effects from the other slices, so a slice full of
+// cheap effects does not leave its thread idle. update() returns only after
+// every effect has rendered, so the buffer always holds a complete frame.
+// Effects must cover disjoint pixel ranges.
+class NeoPixelEffectsParallel {
+  public:
+    NeoPixelEffectsParallel(NeoPixelEffectsManager &manager, unsigned int threads = 0); // 0 uses every core
+    NeoPixelEffectsParallel(NeoPixelEffects *effects, int count, unsigned int threads = 0); // Not limited by NEOPIXELEFFECTS_MAX_MANAGED
+    ~NeoPixelEffectsParallel();
+
+    bool update();  // Process all effects, returns true if any pixels changed
+    bool update(unsigned long now);
+    unsigned int getThreadCount();
+
+  private:
+    struct Slice {
+      std::atomic<int> next;  // Next effect index to claim
+      int end;
+    };
+
+    void startThreads(unsigned int threads);
+    void workerLoop(unsigned int id);
+    void runSlices(unsigned int id);
+
+    NeoPixelEffectsManager *_manager;
+    NeoPixelEffects *_effects;
+    int _count;
+    unsigned int _threadcount;
+    std::thread *_threads;
+    Slice *_slices;
+    std::mutex _lock;
+    std::condition_variable _start;
+    std::condition_variable _done;
+    unsigned long _generation;
+    unsigned int _pending;
+    bool _quit;
+    unsigned long _now;
+    std::atomic<bool> _changed;
+};
+
+#endif
+
+#endif
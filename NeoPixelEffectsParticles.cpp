@@ -0,0 +1,115 @@
+/*-------------------------------------------------------------------------
+  Fixed-capacity particle pool for spark effects.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsParticles.h>
+
+NeoPixelEffectsParticles::NeoPixelEffectsParticles() :
+  _count(0)
+{
+}
+
+bool NeoPixelEffectsParticles::spawn(long position, int velocity, CRGB color_crgb, uint8_t decay)
+{
+  if (_count >= NEOPIXELEFFECTS_MAX_PARTICLES) {
+    return false;
+  }
+  _position[_count] = position;
+  _velocity[_count] = velocity;
+  _color[_count] = color_crgb;
+  _life[_count] = 255;
+  _decay[_count] = max(decay, (uint8_t)1);
+  _count++;
+  return true;
+}
+
+void NeoPixelEffectsParticles::step(int gravity, uint8_t drag, int range)
+{
+  int32_t limit = (int32_t)range << 8;
+  int keep = 256 - drag;
+
+  int i = 0;
+  while (i < _count) {
+    uint8_t life = qsub8(_life[i], _decay[i]);
+    int32_t velocity = _velocity[i] * keep / 256 + gravity;
+    int32_t position = _position[i] + velocity;
+
+    if (life == 0 || position < 0 || position >= limit) {
+      // Fill the gap with the last particle and look at it next
+      _count--;
+      _position[i] = _position[_count];
+      _velocity[i] = _velocity[_count];
+      _color[i] = _color[_count];
+      _life[i] = _life[_count];
+      _decay[i] = _decay[_count];
+      continue;
+    }
+
+    _life[i] = life;
+    _velocity[i] = constrain(velocity, -32768, 32767);
+    _position[i] = position;
+    i++;
+  }
+}
+
+uint32_t NeoPixelEffectsParticles::render(CRGB *pix, int range, bool reverse)
+{
+  uint32_t added = 0;
+  for (int i = 0; i < _count; i++) {
+    int32_t position = _position[i];
+    int index = position >> 8;
+    if (index < 0 || index >= range) {
+      continue;
+    }
+
+    // Split the brightness between the two pixels the particle lies across
+    uint8_t upper = scale8(_life[i], position & 0xFF);
+    uint8_t lower = _life[i] - upper;
+    CRGB color = _color[i];
+
+    CRGB &first = pix[reverse ? range - 1 - index : index];
+    added -= first.r + first.g + first.b;
+    first.r = qadd8(first.r, scale8(color.r, lower));
+    first.g = qadd8(first.g, scale8(color.g, lower));
+    first.b = qadd8(first.b, scale8(color.b, lower));
+    added += first.r + first.g + first.b;
+
+    if (upper > 0 && index + 1 < range) {
+      CRGB &second = pix[reverse ? range - 2 - index : index + 1];
+      added -= second.r + second.g + second.b;
+      second.r = qadd8(second.r, scale8(color.r, upper));
+      second.g = qadd8(second.g, scale8(color.g, upper));
+      second.b = qadd8(second.b, scale8(color.b, upper));
+      added += second.r + second.g + second.b;
+    }
+  }
+  return added;
+}
+
+void NeoPixelEffectsParticles::clear()
+{
+  _count = 0;
+}
+
+int NeoPixelEffectsParticles::getCount()
+{
+  return _count;
+}
+
+int NeoPixelEffectsParticles::getCapacity()
+{
+  return NEOPIXELEFFECTS_MAX_PARTICLES;
+}
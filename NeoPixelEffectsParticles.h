@@ -0,0 +1,56 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSPARTICLES_H
+#define NEOPIXELEFFECTSPARTICLES_H
+
+#include <NeoPixelEffects.h>
+
+// Particles a single pool can hold, 11 bytes each
+#ifndef NEOPIXELEFFECTS_MAX_PARTICLES
+ #if defined(__AVR__)
+  #define NEOPIXELEFFECTS_MAX_PARTICLES 8
+ #else
+  #define NEOPIXELEFFECTS_MAX_PARTICLES 256
+ #endif
+#endif
+
+// A fixed pool of sparks moving along a strip, used by FIREWORK and
+// SPARKLEFILL and usable on its own. Positions are in 1/256 pixel from the
+// start of the range and velocities in 1/256 pixel per frame. Each field is
+// kept in its own array and live particles are packed at the front, so a
+// frame walks a few short arrays and never allocates. A particle starts at
+// full brightness and loses its decay every frame until it burns out.
+class NeoPixelEffectsParticles {
+  public:
+    NeoPixelEffectsParticles();
+
+    bool spawn(long position, int velocity, CRGB color_crgb, uint8_t decay); // false when the pool is full
+    void step(int gravity, uint8_t drag, int range);  // Move every particle one frame; drag is the share of velocity lost, in 1/256
+    uint32_t render(CRGB *pix, int range, bool reverse);  // Add the particles to range pixels, counting from the end if reverse; returns how much the channel sum grew
+    void clear();
+    int getCount();
+    int getCapacity();
+
+  private:
+    int32_t _position[NEOPIXELEFFECTS_MAX_PARTICLES];
+    int16_t _velocity[NEOPIXELEFFECTS_MAX_PARTICLES];
+    CRGB _color[NEOPIXELEFFECTS_MAX_PARTICLES];
+    uint8_t _life[NEOPIXELEFFECTS_MAX_PARTICLES];   // Brightness left
+    uint8_t _decay[NEOPIXELEFFECTS_MAX_PARTICLES];  // Brightness lost per frame
+    int _count;
+};
+
+#endif
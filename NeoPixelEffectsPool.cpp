@@ -0,0 +1,214 @@
+/*-------------------------------------------------------------------------
+  Batched PULSE and STROBE segments stored as structure of arrays.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsPool.h>
+#include <NeoPixelEffectsKernels.h>
+
+NeoPixelEffectsPool::NeoPixelEffectsPool(CRGB *pix, Effect effect, unsigned long delay) :
+  _pixset(pix), _lastupdate(0), _delay(delay), _count(0), _first(0), _last(0),
+  _dirty(false), _resync(true), _effect(effect)
+{
+#if NEOPIXELEFFECTS_POWER
+  _load = 0;
+#endif
+}
+
+int NeoPixelEffectsPool::add(int pixstart, int pixend, CRGB color_crgb, bool dir)
+{
+  if (_count >= NEOPIXELEFFECTS_MAX_POOLED || pixstart < 0 || pixstart > pixend) {
+    return -1;
+  }
+
+  int i = _count++;
+  _start[i] = pixstart;
+  _range[i] = pixend - pixstart + 1;
+  _color[i] = color_crgb;
+  _background[i] = CRGB::Black;
+  // The same starting point NeoPixelEffects::setEffect() picks
+  _counter[i] = (dir == FORWARD) ? 0 : 100;
+  _rising[i] = (dir == FORWARD);
+
+  if (i == 0) {
+    _first = pixstart;
+    _last = pixend;
+  } else {
+    _first = min(_first, pixstart);
+    _last = max(_last, pixend);
+  }
+  return i;
+}
+
+void NeoPixelEffectsPool::removeAll()
+{
+  _count = 0;
+#if NEOPIXELEFFECTS_POWER
+  _load = 0;
+#endif
+}
+
+int NeoPixelEffectsPool::getCount()
+{
+  return _count;
+}
+
+int NeoPixelEffectsPool::getCapacity()
+{
+  return NEOPIXELEFFECTS_MAX_POOLED;
+}
+
+Effect NeoPixelEffectsPool::getEffect()
+{
+  return _effect;
+}
+
+void NeoPixelEffectsPool::setColor(int index, CRGB color_crgb)
+{
+  if (index >= 0 && index < _count) {
+    _color[index] = color_crgb;
+  }
+}
+
+void NeoPixelEffectsPool::setBackgroundColor(int index, CRGB color_crgb)
+{
+  if (index >= 0 && index < _count) {
+    _background[index] = color_crgb;
+  }
+}
+
+void NeoPixelEffectsPool::setDelay(unsigned long delay_ms)
+{
+  _delay = delay_ms;
+  _resync = true;
+}
+
+bool NeoPixelEffectsPool::update()
+{
+  return update(millis());
+}
+
+// One schedule for the whole pool, kept as NeoPixelEffects does with
+// TIMING_SKIP: a late call renders the current tick only
+bool NeoPixelEffectsPool::update(unsigned long now)
+{
+  if (_count == 0) {
+    return false;
+  }
+
+  if (_resync) {
+    _resync = false;
+    _lastupdate = now;
+  } else {
+    unsigned long elapsed = now - _lastupdate;
+    if (elapsed < _delay) {
+      return false;
+    }
+    if (_delay > 0) {
+      _lastupdate += (elapsed / _delay) * _delay;
+    } else {
+      _lastupdate = now;
+    }
+  }
+
+  // First pass: advance every segment and pick its colour
+  if (_effect == PULSE) {
+    stepPulse();
+  } else if (_effect == STROBE) {
+    stepStrobe();
+  } else {
+    return false;
+  }
+
+  // Second pass: fill each segment with its colour
+#if NEOPIXELEFFECTS_POWER
+  uint32_t load = 0;
+#endif
+  for (int i = 0; i < _count; i++) {
+    fillPixels(_pixset + _start[i], _range[i], _drawn[i]);
+#if NEOPIXELEFFECTS_POWER
+    load += (uint32_t)_range[i] * pixelLoad(_drawn[i]);
+#endif
+  }
+#if NEOPIXELEFFECTS_POWER
+  _load = load;
+#endif
+  _dirty = true;
+  return true;
+}
+
+// drawPulse() with the level, then advanceBounce()
+void NeoPixelEffectsPool::stepPulse()
+{
+  for (int i = 0; i < _count; i++) {
+    uint8_t level = _counter[i];
+    CRGB color = _color[i];
+#if NEOPIXELEFFECTS_FIXED_POINT
+    scaleColor(color, percentToFraction(level));
+#else
+    float ratio = level / 100.0;
+    color.r = color.r * ratio;
+    color.g = color.g * ratio;
+    color.b = color.b * ratio;
+#endif
+    _drawn[i] = color;
+
+    bool rising = _rising[i];
+    level = rising ? level + 1 : level - 1;
+    _counter[i] = level;
+    _rising[i] = rising ? (level < 100) : (level == 0);
+  }
+}
+
+// drawStrobe() with the counter, then the counter steps
+void NeoPixelEffectsPool::stepStrobe()
+{
+  for (int i = 0; i < _count; i++) {
+    uint8_t counter = _counter[i];
+    _drawn[i] = (counter & 1) ? _background[i] : _color[i];
+    _counter[i] = counter + 1;
+  }
+}
+
+bool NeoPixelEffectsPool::getDirtyRange(int &first, int &last)
+{
+  if (!_dirty) {
+    return false;
+  }
+  first = _first;
+  last = _last;
+  return true;
+}
+
+void NeoPixelEffectsPool::clearDirty()
+{
+  _dirty = false;
+}
+
+#if NEOPIXELEFFECTS_POWER
+uint32_t NeoPixelEffectsPool::getLoad()
+{
+  return _load;
+}
+
+unsigned long NeoPixelEffectsPool::getCurrent()
+{
+  unsigned long pixels = 0;
+  for (int i = 0; i < _count; i++) {
+    pixels += _range[i];
+  }
+  return ((unsigned long)_load * NEOPIXELEFFECTS_CHANNEL_MA + 127) / 255 + pixels * NEOPIXELEFFECTS_IDLE_MA;
+}
+#endif
@@ -0,0 +1,90 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSPOOL_H
+#define NEOPIXELEFFECTSPOOL_H
+
+#include <NeoPixelEffects.h>
+
+// Segments a single pool can hold
+#ifndef NEOPIXELEFFECTS_MAX_POOLED
+ #if defined(__AVR__)
+  #define NEOPIXELEFFECTS_MAX_POOLED 32
+ #else
+  #define NEOPIXELEFFECTS_MAX_POOLED 1024
+ #endif
+#endif
+
+// Many segments running the same PULSE or STROBE on one clock. Each field
+// of the segments is kept in its own array, and a frame is two passes: one
+// steps every segment's counter and works out its colour, the other fills
+// each segment with it. A pool checks the time once per frame instead of
+// once per segment and has no per-segment dispatch. Every segment draws
+// exactly what a NeoPixelEffects running the same effect with the same
+// settings would.
+class NeoPixelEffectsPool {
+#if NEOPIXELEFFECTS_COMPACT
+    typedef int16_t index_t;
+#else
+    typedef int index_t;
+#endif
+
+  public:
+    NeoPixelEffectsPool(CRGB *pix, Effect effect, unsigned long delay);  // effect is PULSE or STROBE
+
+    int add(int pixstart, int pixend, CRGB color_crgb, bool dir = FORWARD); // Index of the new segment, -1 when full
+    void removeAll();
+    int getCount();
+    int getCapacity();
+    Effect getEffect();
+    void setColor(int index, CRGB color_crgb);            // Used from the next frame; the schedule carries on
+    void setBackgroundColor(int index, CRGB color_crgb);
+    void setDelay(unsigned long delay_ms);  // Restarts the schedule
+
+    bool update();  // Process every segment, returns true if pixels were rendered
+    bool update(unsigned long now);
+    bool getDirtyRange(int &first, int &last);  // Span covering every segment written since clearDirty(), false if none
+    void clearDirty();
+#if NEOPIXELEFFECTS_POWER
+    uint32_t getLoad();           // Channel sum of every segment as last drawn
+    unsigned long getCurrent();   // Estimated draw of every segment, in mA
+#endif
+
+  private:
+    void stepPulse();
+    void stepStrobe();
+
+    CRGB *_pixset;
+    unsigned long _lastupdate;
+    unsigned long _delay;
+    index_t _start[NEOPIXELEFFECTS_MAX_POOLED];
+    index_t _range[NEOPIXELEFFECTS_MAX_POOLED];
+    CRGB _color[NEOPIXELEFFECTS_MAX_POOLED];
+    CRGB _background[NEOPIXELEFFECTS_MAX_POOLED];
+    CRGB _drawn[NEOPIXELEFFECTS_MAX_POOLED];        // Colour of each segment this frame
+    uint8_t _counter[NEOPIXELEFFECTS_MAX_POOLED];   // PULSE level 0-100, STROBE frame parity
+    uint8_t _rising[NEOPIXELEFFECTS_MAX_POOLED];    // PULSE level is going up
+#if NEOPIXELEFFECTS_POWER
+    uint32_t _load;         // Channel sum of the last frame, added up in the fill pass
+#endif
+    int _count;
+    int _first;             // Span covered by the segments
+    int _last;
+    bool _dirty;
+    bool _resync;           // Start a new schedule on the next update
+    Effect _effect;
+};
+
+#endif
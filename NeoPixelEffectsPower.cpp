@@ -0,0 +1,81 @@
+/*-------------------------------------------------------------------------
+  Current limiting from the load estimates kept by each effect.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsPower.h>
+
+#if NEOPIXELEFFECTS_POWER
+
+NeoPixelEffectsPowerLimiter::NeoPixelEffectsPowerLimiter(NeoPixelEffectsManager &manager, NeoPixelEffectsCorrection &correction, int numpix, unsigned long budget_ma) :
+  _manager(manager), _correction(correction), _idle((unsigned long)numpix * NEOPIXELEFFECTS_IDLE_MA),
+  _budget(budget_ma), _current(0), _limited(0), _poolcount(0)
+{
+}
+
+bool NeoPixelEffectsPowerLimiter::addPool(NeoPixelEffectsPool *pool)
+{
+  if (_poolcount >= NEOPIXELEFFECTS_MAX_LIMITED_POOLS) {
+    return false;
+  }
+  _pools[_poolcount++] = pool;
+  return true;
+}
+
+void NeoPixelEffectsPowerLimiter::setBudget(unsigned long budget_ma)
+{
+  _budget = budget_ma;
+}
+
+unsigned long NeoPixelEffectsPowerLimiter::getBudget()
+{
+  return _budget;
+}
+
+bool NeoPixelEffectsPowerLimiter::update()
+{
+  // Draw of the lit channels at full brightness, then at the correction's
+  uint32_t load = _manager.getLoad();
+  for (int i = 0; i < _poolcount; i++) {
+    load += _pools[i]->getLoad();
+  }
+  unsigned long lit = ((unsigned long)load * NEOPIXELEFFECTS_CHANNEL_MA + 127) / 255;
+  lit = (lit * _correction.getBrightness() + 127) / 255;
+
+  _current = _idle + lit;
+  uint8_t limit = 255;
+  if (_current > _budget && lit > 0) {
+    // Only the lit part dims; the idle draw is there regardless. apply()
+    // scales by (limit + 1) / 256, rounding down.
+    unsigned long spare = (_budget > _idle) ? _budget - _idle : 0;
+    unsigned long scale = spare * 256 / lit;
+    limit = (scale > 0) ? min(scale - 1, 255UL) : 0;
+  }
+  _correction.setLimit(limit);
+  _limited = _idle + ((limit < 255) ? (lit * (limit + 1)) >> 8 : lit);
+  return limit < 255;
+}
+
+unsigned long NeoPixelEffectsPowerLimiter::getCurrent()
+{
+  return _current;
+}
+
+unsigned long NeoPixelEffectsPowerLimiter::getLimitedCurrent()
+{
+  return _limited;
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSPOWER_H
+#define NEOPIXELEFFECTSPOWER_H
+
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsManager.h>
+#include <NeoPixelEffectsCorrection.h>
+#include <NeoPixelEffectsPool.h>
+
+#if NEOPIXELEFFECTS_POWER
+
+// Pools a single limiter can count besides its manager
+#ifndef NEOPIXELEFFECTS_MAX_LIMITED_POOLS
+ #define NEOPIXELEFFECTS_MAX_LIMITED_POOLS 4
+#endif
+
+// Keeps a strip within the current its supply can deliver. update() adds up
+// the load each effect and each added pool keeps as it draws, which costs
+// one addition per effect or pool, and when the estimate is over budget dims the next apply() of the
+// correction just enough to fit. The estimate is taken before gamma and
+// white balance, so it errs high when gamma is 1 or more.
+class NeoPixelEffectsPowerLimiter {
+  public:
+    NeoPixelEffectsPowerLimiter(NeoPixelEffectsManager &manager, NeoPixelEffectsCorrection &correction, int numpix, unsigned long budget_ma);
+
+    bool addPool(NeoPixelEffectsPool *pool);  // Count a pool's segments too, false when full
+    void setBudget(unsigned long budget_ma);
+    unsigned long getBudget();
+
+    bool update();  // After the effects and before apply(), true if this frame is dimmed
+    unsigned long getCurrent();         // Estimated draw of the last frame, in mA
+    unsigned long getLimitedCurrent();  // The same after dimming
+
+  private:
+    NeoPixelEffectsManager &_manager;
+    NeoPixelEffectsCorrection &_correction;
+    unsigned long _idle;    // Draw of the strip with every pixel off
+    unsigned long _budget;
+    unsigned long _current;
+    unsigned long _limited;
+    NeoPixelEffectsPool *_pools[NEOPIXELEFFECTS_MAX_LIMITED_POOLS];
+    uint8_t _poolcount;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,631 @@
+/*-------------------------------------------------------------------------
+  Recording pixel output to a compact delta format and playing it back.
+  -------------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  -------------------------------------------------------------------------*/
+
+#include <NeoPixelEffectsRecording.h>
+#include <NeoPixelEffectsKernels.h>
+
+#ifdef NEOPIXELEFFECTS_HAS_MMAP
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+#endif
+
+#define OP_SKIP       0x00
+#define OP_LITERAL    0x40
+#define OP_REPEAT     0x80
+#define OP_END        0xC0
+#define OP_LONGSKIP   0xC0
+#define OP_COUNT      0x3F
+
+#define FRAME_KEY     0x01
+#define FRAME_TOSTART 0x02    // Shift the last frame one pixel towards the start first
+#define FRAME_TOEND   0x04    // Shift it one pixel towards the end first
+
+#define HEADER_SIZE   12
+#define FOOTER_SIZE   16
+
+// Shortest run of one colour given a repeat opcode: 4 bytes against 9 as
+// literals. Shorter runs would save a byte or two but split literals up,
+// costing an opcode each in playback.
+#define MIN_REPEAT    3
+
+static inline bool samePixel(const CRGB &a, const CRGB &b)
+{
+  return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+static int countChanges(const CRGB *pixels, const CRGB *reference, int count)
+{
+  int changes = 0;
+  for (int i = 0; i < count; i++) {
+    if (!samePixel(pixels[i], reference[i])) {
+      changes++;
+    }
+  }
+  return changes;
+}
+
+NeoPixelEffectsRecorder::NeoPixelEffectsRecorder(const CRGB *pixels, int numpix) :
+  _pixels(pixels), _numpix(numpix), _previous(NULL), _shifted(NULL), _file(NULL), _index(NULL),
+  _indexcount(0), _indexsize(0), _frames(0), _bytes(0), _keyinterval(NEOPIXELEFFECTS_KEYFRAME_INTERVAL),
+  _buffered(0), _error(false)
+{
+}
+
+NeoPixelEffectsRecorder::~NeoPixelEffectsRecorder()
+{
+  delete[] _previous;
+  delete[] _shifted;
+  delete[] _index;
+}
+
+bool NeoPixelEffectsRecorder::begin(FILE *file, unsigned long delay_ms, unsigned int keyinterval)
+{
+  if (file == NULL || _numpix <= 0 || _numpix > 65535) {
+    return false;
+  }
+  delete[] _previous;
+  delete[] _shifted;
+  delete[] _index;
+  _previous = new CRGB[_numpix];
+  _shifted = new CRGB[_numpix];
+  _index = NULL;
+  _indexcount = 0;
+  _indexsize = 0;
+  _file = file;
+  _frames = 0;
+  _bytes = 0;
+  _buffered = 0;
+  _error = false;
+  _keyinterval = constrain(keyinterval, 1U, 65535U);
+
+  putBytes("NPXR", 4);
+  put(NEOPIXELEFFECTS_RECORDING_VERSION);
+  put(0);
+  putWord(_numpix);
+  putWord(min(delay_ms, 65535UL));
+  putWord(_keyinterval);
+  flushBuffer();
+  return !_error;
+}
+
+bool NeoPixelEffectsRecorder::record()
+{
+  if (_file == NULL) {
+    return false;
+  }
+
+  bool keyframe = (_frames % _keyinterval == 0);
+  if (keyframe) {
+    flushBuffer();
+    if (_indexcount + 2 > _indexsize) {
+      // Grow the index by doubling, it holds two words per keyframe
+      unsigned long size = (_indexsize > 0) ? _indexsize * 2 : 64;
+      uint32_t *index = new uint32_t[size];
+      if (_indexcount > 0) {
+        memcpy(index, _index, _indexcount * sizeof(uint32_t));
+      }
+      delete[] _index;
+      _index = index;
+      _indexsize = size;
+    }
+    _index[_indexcount++] = _frames;
+    _index[_indexcount++] = _bytes;
+  }
+
+  encodeFrame(keyframe);
+  memcpy(_previous, _pixels, _numpix * sizeof(CRGB));
+  _frames++;
+  flushBuffer();
+  return !_error;
+}
+
+void NeoPixelEffectsRecorder::encodeFrame(bool keyframe)
+{
+  const CRGB *reference = _previous;
+  uint8_t flags = 0;
+
+  if (keyframe) {
+    fillPixels(_shifted, _numpix, CRGB(0, 0, 0));
+    reference = _shifted;
+    flags = FRAME_KEY;
+  } else if (_numpix > 1) {
+    // Scrolling effects move the whole frame by a pixel; code whichever of
+    // the last frame and its two shifts leaves the fewest changes
+    int best = countChanges(_pixels, _previous, _numpix);
+    for (int towardstart = 1; towardstart >= 0; towardstart--) {
+      memcpy(_shifted, _previous, _numpix * sizeof(CRGB));
+      shiftPixels(_shifted, _numpix, towardstart);
+      int changes = countChanges(_pixels, _shifted, _numpix);
+      if (changes < best) {
+        best = changes;
+        flags = towardstart ? FRAME_TOSTART : FRAME_TOEND;
+      }
+    }
+    if (flags != 0) {
+      memcpy(_shifted, _previous, _numpix * sizeof(CRGB));
+      shiftPixels(_shifted, _numpix, flags == FRAME_TOSTART);
+      reference = _shifted;
+    }
+  }
+  put(flags);
+
+  int i = 0;
+  while (i < _numpix) {
+    const CRGB &pixel = _pixels[i];
+
+    // Pixels that match the last frame, or black in a keyframe
+    int skip = 0;
+    while (i + skip < _numpix && samePixel(_pixels[i + skip], reference[i + skip])) {
+      skip++;
+    }
+    if (skip > 0) {
+      while (skip >= 64) {
+        int blocks = min(skip / 64, OP_COUNT);
+        put(OP_LONGSKIP | blocks);
+        skip -= blocks * 64;
+        i += blocks * 64;
+      }
+      if (skip > 0) {
+        put(OP_SKIP | (skip - 1));
+        i += skip;
+      }
+      continue;
+    }
+
+    int repeat = 1;
+    while (i + repeat < _numpix && repeat <= OP_COUNT && samePixel(_pixels[i + repeat], pixel)) {
+      repeat++;
+    }
+    if (repeat >= MIN_REPEAT) {
+      put(OP_REPEAT | (repeat - 1));
+      putBytes(&pixel, sizeof(CRGB));
+      i += repeat;
+      continue;
+    }
+
+    // Changed pixels up to the next unchanged pixel or run of one colour
+    int literal = 1;
+    while (i + literal < _numpix && literal <= OP_COUNT) {
+      int j = i + literal;
+      if (samePixel(_pixels[j], reference[j])) {
+        break;
+      }
+      if (j + MIN_REPEAT <= _numpix && samePixel(_pixels[j + 1], _pixels[j]) && samePixel(_pixels[j + 2], _pixels[j])) {
+        break;
+      }
+      literal++;
+    }
+    put(OP_LITERAL | (literal - 1));
+    putBytes(_pixels + i, literal * sizeof(CRGB));
+    i += literal;
+  }
+
+  put(OP_END);
+}
+
+bool NeoPixelEffectsRecorder::end()
+{
+  if (_file == NULL) {
+    return false;
+  }
+  unsigned long indexoffset = _bytes;
+  for (unsigned long i = 0; i < _indexcount; i++) {
+    putLong(_index[i]);
+  }
+  putLong(indexoffset);
+  putLong(_indexcount / 2);
+  putLong(_frames);
+  putBytes("NPXI", 4);
+  flushBuffer();
+  if (fflush(_file) != 0) {
+    _error = true;
+  }
+
+  _file = NULL;
+  delete[] _previous;
+  delete[] _shifted;
+  delete[] _index;
+  _previous = NULL;
+  _shifted = NULL;
+  _index = NULL;
+  return !_error;
+}
+
+unsigned long NeoPixelEffectsRecorder::getFrames()
+{
+  return _frames;
+}
+
+unsigned long NeoPixelEffectsRecorder::getBytes()
+{
+  return _bytes;
+}
+
+void NeoPixelEffectsRecorder::put(uint8_t value)
+{
+  if (_buffered == (int)sizeof(_buffer)) {
+    flushBuffer();
+  }
+  _buffer[_buffered++] = value;
+  _bytes++;
+}
+
+void NeoPixelEffectsRecorder::putBytes(const void *data, int length)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (int i = 0; i < length; i++) {
+    put(bytes[i]);
+  }
+}
+
+void NeoPixelEffectsRecorder::putWord(uint16_t value)
+{
+  put(value & 0xFF);
+  put(value >> 8);
+}
+
+void NeoPixelEffectsRecorder::putLong(uint32_t value)
+{
+  putWord(value & 0xFFFF);
+  putWord(value >> 16);
+}
+
+void NeoPixelEffectsRecorder::flushBuffer()
+{
+  if (_buffered > 0 && fwrite(_buffer, 1, _buffered, _file) != (size_t)_buffered) {
+    _error = true;
+  }
+  _buffered = 0;
+}
+
+NeoPixelEffectsPlayer::NeoPixelEffectsPlayer(CRGB *pixels, int numpix) :
+  _pixels(pixels), _numpix(numpix), _data(NULL), _length(0), _frameend(0), _indexcount(0),
+  _framecount(0), _offset(0), _next(0), _lastupdate(0), _delay(0), _keyinterval(0),
+  _dirtystart(1), _dirtyend(0), _progmem(false), _repeat(false), _started(false)
+#ifdef NEOPIXELEFFECTS_HAS_MMAP
+  , _mapping(NULL), _mappedlength(0)
+#endif
+{
+}
+
+NeoPixelEffectsPlayer::~NeoPixelEffectsPlayer()
+{
+  close();
+}
+
+bool NeoPixelEffectsPlayer::begin(const uint8_t *data, unsigned long length)
+{
+  _progmem = false;
+  return beginData(data, length);
+}
+
+#ifdef __AVR__
+bool NeoPixelEffectsPlayer::beginProgmem(const uint8_t *data, unsigned long length)
+{
+  _progmem = true;
+  return beginData(data, length);
+}
+#endif
+
+#ifdef NEOPIXELEFFECTS_HAS_MMAP
+bool NeoPixelEffectsPlayer::open(const char *path)
+{
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  void *mapping = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  _mapping = mapping;
+  _mappedlength = info.st_size;
+  if (!begin((const uint8_t *)mapping, info.st_size)) {
+    close();
+    return false;
+  }
+  return true;
+}
+#endif
+
+void NeoPixelEffectsPlayer::close()
+{
+#ifdef NEOPIXELEFFECTS_HAS_MMAP
+  if (_mapping != NULL) {
+    munmap(_mapping, _mappedlength);
+    _mapping = NULL;
+    _mappedlength = 0;
+  }
+#endif
+  _data = NULL;
+  _length = 0;
+  _framecount = 0;
+}
+
+bool NeoPixelEffectsPlayer::beginData(const uint8_t *data, unsigned long length)
+{
+  _data = data;
+  _length = length;
+  _framecount = 0;
+
+  if (data == NULL || length < HEADER_SIZE + FOOTER_SIZE) {
+    _data = NULL;
+    return false;
+  }
+
+  unsigned long footer = length - FOOTER_SIZE;
+  bool valid =
+    readByte(0) == 'N' && readByte(1) == 'P' && readByte(2) == 'X' && readByte(3) == 'R' &&
+    readByte(4) == NEOPIXELEFFECTS_RECORDING_VERSION && readWord(6) == _numpix &&
+    readByte(footer + 12) == 'N' && readByte(footer + 13) == 'P' &&
+    readByte(footer + 14) == 'X' && readByte(footer + 15) == 'I';
+  if (valid) {
+    _frameend = readLong(footer);
+    _indexcount = readLong(footer + 4);
+    // The index must sit between the frames and the footer
+    valid = _frameend >= HEADER_SIZE && _frameend <= footer && _indexcount > 0 &&
+      (footer - _frameend) / 8 >= _indexcount;
+  }
+  if (!valid) {
+    _data = NULL;
+    return false;
+  }
+
+  _framecount = readLong(footer + 8);
+  _delay = readWord(8);
+  _keyinterval = readWord(10);
+  _offset = HEADER_SIZE;
+  _next = 0;
+  _started = false;
+  return true;
+}
+
+bool NeoPixelEffectsPlayer::update()
+{
+  return update(millis());
+}
+
+bool NeoPixelEffectsPlayer::update(unsigned long now)
+{
+  if (_data == NULL) {
+    return false;
+  }
+  if (!_started) {
+    _started = true;
+    _lastupdate = now;
+    return nextFrame();
+  }
+
+  unsigned long elapsed = now - _lastupdate;
+  if (elapsed < _delay) {
+    return false;
+  }
+  unsigned long periods = (_delay > 0) ? elapsed / _delay : 1;
+  _lastupdate = (_delay > 0) ? _lastupdate + periods * _delay : now;
+
+  // Stay on the recorded timeline; a long stall is cheaper to seek over
+  if (periods > _keyinterval && _framecount > 0) {
+    unsigned long target = _next + periods - 1;
+    if (target >= _framecount) {
+      if (!_repeat) {
+        return _next < _framecount && seek(_framecount - 1);
+      }
+      target %= _framecount;
+    }
+    return seek(target);
+  }
+  bool changed = false;
+  for (unsigned long i = 0; i < periods; i++) {
+    if (!nextFrame()) {
+      break;
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+bool NeoPixelEffectsPlayer::nextFrame()
+{
+  if (_data == NULL || _framecount == 0) {
+    return false;
+  }
+  if (_next >= _framecount) {
+    if (!_repeat) {
+      return false;
+    }
+    _offset = HEADER_SIZE;
+    _next = 0;
+  }
+  decodeFrame();
+  return true;
+}
+
+bool NeoPixelEffectsPlayer::seek(unsigned long frame)
+{
+  if (_data == NULL || frame >= _framecount) {
+    return false;
+  }
+
+  // Last keyframe at or before the frame
+  unsigned long low = 0;
+  unsigned long high = _indexcount;
+  while (high - low > 1) {
+    unsigned long mid = (low + high) / 2;
+    if (readLong(_frameend + mid * 8) <= frame) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+  _next = readLong(_frameend + low * 8);
+  _offset = readLong(_frameend + low * 8 + 4);
+  if (_next > frame || _offset < HEADER_SIZE || _offset >= _frameend) {
+    return false;
+  }
+
+  while (_next <= frame) {
+    decodeFrame();
+  }
+  return true;
+}
+
+void NeoPixelEffectsPlayer::decodeFrame()
+{
+  unsigned long offset = _offset;
+  uint8_t flags = readByte(offset++);
+  if (flags & FRAME_KEY) {
+    fillPixels(_pixels, _numpix, CRGB(0, 0, 0));
+    markDirty(0, _numpix - 1);
+  } else if (flags & (FRAME_TOSTART | FRAME_TOEND)) {
+    shiftPixels(_pixels, _numpix, flags & FRAME_TOSTART);
+    markDirty(0, _numpix - 1);
+  }
+
+  int i = 0;
+  while (offset < _frameend) {
+    uint8_t op = readByte(offset++);
+    if (op == OP_END) {
+      break;
+    }
+    int count = (op & OP_COUNT) + 1;
+    switch (op & ~OP_COUNT) {
+      case OP_SKIP:
+        i += count;
+        break;
+      case OP_LITERAL:
+        count = min(count, _numpix - i);
+        if (count > 0) {
+          readBytes(_pixels + i, offset, count * sizeof(CRGB));
+          markDirty(i, i + count - 1);
+          i += count;
+        }
+        offset += ((op & OP_COUNT) + 1) * sizeof(CRGB);
+        break;
+      case OP_REPEAT:
+        count = min(count, _numpix - i);
+        if (count > 0) {
+          CRGB color;
+          readBytes(&color, offset, sizeof(CRGB));
+          fillPixels(_pixels + i, count, color);
+          markDirty(i, i + count - 1);
+          i += count;
+        }
+        offset += sizeof(CRGB);
+        break;
+      default:
+        i += (op & OP_COUNT) * 64;
+        break;
+    }
+  }
+
+  _offset = offset;
+  _next++;
+}
+
+void NeoPixelEffectsPlayer::setRepeat(bool repeat)
+{
+  _repeat = repeat;
+}
+
+unsigned long NeoPixelEffectsPlayer::getFrame()
+{
+  return (_next > 0) ? _next - 1 : 0;
+}
+
+unsigned long NeoPixelEffectsPlayer::getFrameCount()
+{
+  return _framecount;
+}
+
+unsigned long NeoPixelEffectsPlayer::getDelay()
+{
+  return _delay;
+}
+
+bool NeoPixelEffectsPlayer::getDirtyRange(int &first, int &last)
+{
+  if (_dirtyend < _dirtystart) {
+    return false;
+  }
+  first = _dirtystart;
+  last = _dirtyend;
+  return true;
+}
+
+void NeoPixelEffectsPlayer::clearDirty()
+{
+  _dirtystart = 1;
+  _dirtyend = 0;
+}
+
+void NeoPixelEffectsPlayer::markDirty(int first, int last)
+{
+  if (_dirtyend < _dirtystart) {
+    _dirtystart = first;
+    _dirtyend = last;
+  } else {
+    _dirtystart = min(_dirtystart, first);
+    _dirtyend = max(_dirtyend, last);
+  }
+}
+
+uint8_t NeoPixelEffectsPlayer::readByte(unsigned long offset)
+{
+  if (offset >= _length) {
+    return 0;
+  }
+#ifdef __AVR__
+  if (_progmem) {
+    return pgm_read_byte(_data + offset);
+  }
+#endif
+  return _data[offset];
+}
+
+void NeoPixelEffectsPlayer::readBytes(void *dest, unsigned long offset, unsigned long length)
+{
+  if (offset >= _length || length > _length - offset) {
+    memset(dest, 0, length);
+    return;
+  }
+#ifdef __AVR__
+  if (_progmem) {
+    memcpy_P(dest, _data + offset, length);
+    return;
+  }
+#endif
+  memcpy(dest, _data + offset, length);
+}
+
+uint16_t NeoPixelEffectsPlayer::readWord(unsigned long offset)
+{
+  return readByte(offset) | ((uint16_t)readByte(offset + 1) << 8);
+}
+
+uint32_t NeoPixelEffectsPlayer::readLong(unsigned long offset)
+{
+  return readWord(offset) | ((uint32_t)readWord(offset + 2) << 16);
+}
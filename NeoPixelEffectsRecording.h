@@ -0,0 +1,152 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+#ifndef NEOPIXELEFFECTSRECORDING_H
+#define NEOPIXELEFFECTSRECORDING_H
+
+#include <NeoPixelEffects.h>
+#include <stdio.h>
+
+#if defined(__has_include)
+ #if __has_include(<sys/mman.h>) && __has_include(<fcntl.h>)
+  #define NEOPIXELEFFECTS_HAS_MMAP 1
+ #endif
+#endif
+
+// Frames between keyframes unless the recorder is told otherwise. Seeking
+// decodes at most this many frames.
+#ifndef NEOPIXELEFFECTS_KEYFRAME_INTERVAL
+ #define NEOPIXELEFFECTS_KEYFRAME_INTERVAL 50
+#endif
+
+// Recordings are a 12 byte header, the frames, a keyframe index and a
+// 16 byte footer, all little endian:
+//   header   "NPXR", version, 0, pixels (16), delay ms (16), keyframe interval (16)
+//   frame    flags, opcodes, end opcode
+//   index    frame number (32) and offset (32) of each keyframe
+//   footer   index offset (32), keyframe count (32), frame count (32), "NPXI"
+// Each frame is coded against the one before it, and a keyframe (flag 1)
+// against black so playback can start there. Flag 2 or 4 first moves the
+// last frame one pixel towards the start or the end, as scrolling effects
+// do; the pixel left behind keeps its value. Opcodes are one byte:
+//   00nnnnnn  skip n + 1 unchanged pixels
+//   01nnnnnn  n + 1 pixels follow as RGB bytes
+//   10nnnnnn  the RGB bytes that follow repeat for n + 1 pixels
+//   11000000  end of frame
+//   11nnnnnn  skip n * 64 unchanged pixels
+#define NEOPIXELEFFECTS_RECORDING_VERSION 1
+
+// Captures a pixel buffer once per tick into a recording written to a
+// stdio file, for shows rendered ahead of time on a host
+class NeoPixelEffectsRecorder {
+  public:
+    NeoPixelEffectsRecorder(const CRGB *pixels, int numpix);
+    ~NeoPixelEffectsRecorder();
+
+    bool begin(FILE *file, unsigned long delay_ms, unsigned int keyinterval = NEOPIXELEFFECTS_KEYFRAME_INTERVAL);
+    bool record();  // Append the pixels as they are now as the next frame
+    bool end();     // Write the index and footer; the file stays open
+
+    unsigned long getFrames();
+    unsigned long getBytes();   // Written so far, including header and index
+
+  private:
+    void encodeFrame(bool keyframe);
+    void put(uint8_t value);
+    void putBytes(const void *data, int length);
+    void putWord(uint16_t value);
+    void putLong(uint32_t value);
+    void flushBuffer();
+
+    const CRGB *_pixels;
+    int _numpix;
+    CRGB *_previous;        // Last frame recorded
+    CRGB *_shifted;         // Reference the frame is coded against when not the last frame
+    FILE *_file;
+    uint32_t *_index;       // Frame number and offset of each keyframe
+    unsigned long _indexcount;
+    unsigned long _indexsize;
+    unsigned long _frames;
+    unsigned long _bytes;
+    unsigned int _keyinterval;
+    uint8_t _buffer[256];   // Staging for small writes
+    int _buffered;
+    bool _error;
+};
+
+// Plays a recording into a pixel buffer. The recording is read in place:
+// from RAM, from flash that is mapped into memory (ESP32, ARM), from
+// PROGMEM on AVR or from a file mapped into memory on Linux. A frame costs
+// time in proportion to the pixels that changed, and only those are
+// written, so the pixel buffer must not be changed by anything else while
+// playing.
+class NeoPixelEffectsPlayer {
+  public:
+    NeoPixelEffectsPlayer(CRGB *pixels, int numpix);
+    ~NeoPixelEffectsPlayer();
+
+    bool begin(const uint8_t *data, unsigned long length);  // false if data is not a recording for numpix pixels
+#ifdef __AVR__
+    bool beginProgmem(const uint8_t *data, unsigned long length);
+#endif
+#ifdef NEOPIXELEFFECTS_HAS_MMAP
+    bool open(const char *path);  // Map a recording file into memory and begin it
+#endif
+    void close();
+
+    bool update();  // Show the frame due at the recorded rate, returns true if pixels changed
+    bool update(unsigned long now);
+    bool nextFrame();   // Decode the next frame, false at the end of a recording that does not repeat
+    bool seek(unsigned long frame); // Decode the given frame, starting from the keyframe before it
+    void setRepeat(bool repeat);    // Start over after the last frame
+    unsigned long getFrame();       // Number of the frame shown, from 0
+    unsigned long getFrameCount();
+    unsigned long getDelay();
+    bool getDirtyRange(int &first, int &last); // Pixels written since clearDirty(), false if none
+    void clearDirty();
+
+  private:
+    uint8_t readByte(unsigned long offset);
+    void readBytes(void *dest, unsigned long offset, unsigned long length);
+    uint16_t readWord(unsigned long offset);
+    uint32_t readLong(unsigned long offset);
+    bool beginData(const uint8_t *data, unsigned long length);
+    void decodeFrame();
+    void markDirty(int first, int last);
+
+    CRGB *_pixels;
+    int _numpix;
+    const uint8_t *_data;
+    unsigned long _length;
+    unsigned long _frameend;    // Where the index starts
+    unsigned long _indexcount;
+    unsigned long _framecount;
+    unsigned long _offset;      // Offset of the next frame
+    unsigned long _next;        // Number of the next frame
+    unsigned long _lastupdate;
+    uint16_t _delay;
+    uint16_t _keyinterval;
+    int _dirtystart;
+    int _dirtyend;
+    bool _progmem;
+    bool _repeat;
+    bool _started;
+#ifdef NEOPIXELEFFECTS_HAS_MMAP
+    void *_mapping;
+    unsigned long _mappedlength;
+#endif
+};
+
+#endif
@@ -2,6 +2,7 @@
 // released under the GPLv3 license
 
 #include "NeoPixelEffects.h"
+#include "NeoPixelEffectsManager.h"
 #include "FastLED.h"
 #ifdef __AVR__
   #include <avr/power.h>
@@ -20,6 +21,7 @@ bool state_e6 = true;
 CRGB color_val;
 
 NeoPixelEffects effects[9];
+NeoPixelEffectsManager manager;
 
 CRGB gradhue1 = CHSV(0, 255, 255);
 CRGB gradhue2 = CHSV(128, 255, 255);
@@ -56,15 +58,18 @@ void setup() {
   color_val.setHue(hue);
   effects[8] = NeoPixelEffects(leds, RAINBOWWAVE, 128, 142, 1, delay_ms, color_val, true, dir);
 
-  Serial.begin(9600);
-}
-
-void loop() {
+  // effects[7] holds a static gradient and is never updated
   for (int i = 0; i < 9; i++) {
     if (i != 7) {
-      effects[i].update();
+      manager.add(&effects[i]);
     }
   }
+
+  Serial.begin(9600);
+}
+
+void loop() {
+  bool changed = manager.update();
   if (effects[5].getEffect() == NONE) {
     if (state_e5) {
       effects[5].setEffect(FADE);
@@ -85,5 +90,8 @@ void loop() {
     state_e6 = !state_e6;
   }
 
-  FastLED.show();
+  // Only push a frame when at least one effect rendered
+  if (changed) {
+    FastLED.show();
+  }
 }
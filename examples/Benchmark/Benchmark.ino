@@ -0,0 +1,87 @@
+// NeoPixel Effects library update() benchmark
+// released under the GPLv3 license
+//
+// Drives every effect through update() over a range of strip sizes and
+// prints the cost per frame and per pixel over serial. The effect clock is
+// supplied by the sketch, so each call renders exactly one frame no matter
+// how fast the board is. Nothing is pushed to the strip; only the render
+// cost is measured.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsParticles.h"
+#include "FastLED.h"
+#ifdef __AVR__
+  #include <avr/power.h>
+#endif
+
+#if defined(__AVR__)
+  #define NUM_LEDS          256
+#elif defined(ARDUINO_ARCH_SAMD)
+  #define NUM_LEDS         2048
+#else
+  #define NUM_LEDS        10000
+#endif
+
+#define NUM_FRAMES          200
+
+CRGB leds[NUM_LEDS];
+NeoPixelEffectsParticles particles;
+
+const int sizes[] = {16, 64, 256, 1024, 4096, 10000};
+const int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+const char *effect_names[NUM_EFFECT] = {
+  "NONE", "COMET", "LARSON", "CHASE", "PULSE", "STATIC", "FADE", "FILLIN",
+  "GLOW", "RAINBOWWAVE", "STROBE", "SINEWAVE", "RANDOM", "TALKING", "TRIWAVE",
+  "FIREWORK", "SPARKLEFILL"
+};
+
+unsigned long benchmarkEffect(Effect effect, int numpix)
+{
+  NeoPixelEffects fx = NeoPixelEffects(leds, effect, 0, numpix - 1, max(numpix / 8, 1), 0, CRGB::Cyan, true, FORWARD);
+#if NEOPIXELEFFECTS_PARTICLES
+  fx.setParticles(&particles);
+#endif
+  fx.fill_solid(CRGB::White);
+
+  unsigned long now = 0;
+  unsigned long start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    // One-shot effects (FADE, FILLIN, FIREWORK) pause themselves; restart them in place
+    if (fx.getStatus() != ACTIVE) {
+      fx.setEffect(effect);
+    }
+    now++;
+    fx.update(now);
+  }
+  return micros() - start;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  Serial.print(F("sizeof(NeoPixelEffects) = "));
+  Serial.print((unsigned int)sizeof(NeoPixelEffects));
+  Serial.print(F(" bytes, NEOPIXELEFFECTS_COMPACT = "));
+  Serial.println(NEOPIXELEFFECTS_COMPACT);
+  Serial.println();
+
+  Serial.println(F("effect,pixels,ns/frame,ns/pixel"));
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    for (int s = 0; s < num_sizes && sizes[s] <= NUM_LEDS; s++) {
+      unsigned long elapsed = benchmarkEffect((Effect)e, sizes[s]);
+      unsigned long ns_frame = (unsigned long)((elapsed * 1000.0) / NUM_FRAMES);
+      Serial.print(effect_names[e]);
+      Serial.print(',');
+      Serial.print(sizes[s]);
+      Serial.print(',');
+      Serial.print(ns_frame);
+      Serial.print(',');
+      Serial.println((float)ns_frame / sizes[s], 2);
+    }
+  }
+}
+
+void loop() {
+}
@@ -0,0 +1,86 @@
+// NeoPixel Effects library lookup table benchmark
+// released under the GPLv3 license
+//
+// Times SINEWAVE, TRIWAVE and RAINBOWWAVE with and without a
+// NeoPixelEffectsCache over a range of strip sizes and prints the cost per
+// frame, the speedup and the RAM the cache takes for that size as CSV.
+// On AVR, build the whole library with NEOPIXELEFFECTS_CACHE set to 1, e.g.
+// with build_flags = -DNEOPIXELEFFECTS_CACHE=1 in PlatformIO.
+
+#include "NeoPixelEffects.h"
+#include "FastLED.h"
+
+#if !NEOPIXELEFFECTS_CACHE
+  #error "Build with NEOPIXELEFFECTS_CACHE=1, the default except in compact builds"
+#endif
+
+#if defined(__AVR__)
+  #define NUM_LEDS          128
+#elif defined(ARDUINO_ARCH_SAMD)
+  #define NUM_LEDS         2048
+#else
+  #define NUM_LEDS         4096
+#endif
+
+#define NUM_FRAMES          200
+
+CRGB leds[NUM_LEDS];
+uint8_t phases[NUM_LEDS];
+NeoPixelEffectsCache cache(phases, NUM_LEDS);
+
+const int sizes[] = {16, 64, 128, 256, 1024, 4096};
+const int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+unsigned long benchmarkEffect(Effect effect, int numpix, bool cached)
+{
+  NeoPixelEffects fx = NeoPixelEffects(leds, effect, 0, numpix - 1, 1, 0, CRGB::Cyan, true, FORWARD);
+  if (cached) {
+    fx.setCache(&cache);
+    fx.update(0);   // Build the tables outside the timed loop
+  }
+
+  unsigned long now = 0;
+  unsigned long start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    now++;
+    fx.update(now);
+  }
+  return micros() - start;
+}
+
+void printEffect(Effect effect)
+{
+  for (int s = 0; s < num_sizes && sizes[s] <= NUM_LEDS; s++) {
+    unsigned long plain = benchmarkEffect(effect, sizes[s], false);
+    unsigned long cached = benchmarkEffect(effect, sizes[s], true);
+    switch (effect) {
+      case SINEWAVE: Serial.print(F("SINEWAVE")); break;
+      case TRIWAVE: Serial.print(F("TRIWAVE")); break;
+      default: Serial.print(F("RAINBOWWAVE")); break;
+    }
+    Serial.print(',');
+    Serial.print(sizes[s]);
+    Serial.print(',');
+    Serial.print((unsigned long)((plain * 1000.0) / NUM_FRAMES));
+    Serial.print(',');
+    Serial.print((unsigned long)((cached * 1000.0) / NUM_FRAMES));
+    Serial.print(',');
+    Serial.print((float)plain / max(cached, 1UL), 2);
+    Serial.print(',');
+    // The ramp, plus the phase table only the waves read
+    Serial.println((unsigned long)(sizeof(NeoPixelEffectsCache) + (effect == RAINBOWWAVE ? 0 : sizes[s])));
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  Serial.println(F("effect,pixels,ns/frame,ns/frame cached,speedup,cache bytes"));
+  printEffect(SINEWAVE);
+  printEffect(TRIWAVE);
+  printEffect(RAINBOWWAVE);
+}
+
+void loop() {
+}
@@ -0,0 +1,74 @@
+// NeoPixel Effects library compiled effect benchmark
+// released under the GPLv3 license
+//
+// Times a few effects as the runtime-selectable NeoPixelEffects class and as
+// NeoPixelEffectsCompiled<> and prints the cost per frame of each as CSV.
+//
+// To compare flash and RAM, build the sketch once with FORMS set to 0 and
+// once with it set to 1 and note what the IDE reports after "Sketch uses"
+// and "Global variables use". With 2 both forms are linked in, so only the
+// timings are meaningful.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsCompiled.h"
+#include "FastLED.h"
+
+#define FORMS                 2   // 0 runtime only, 1 compiled only, 2 both
+
+#if defined(__AVR__)
+  #define NUM_LEDS          256
+#else
+  #define NUM_LEDS         1024
+#endif
+
+#define NUM_FRAMES          200
+
+CRGB leds[NUM_LEDS];
+
+template <class T>
+unsigned long runFrames(T &fx)
+{
+  unsigned long now = 0;
+  unsigned long start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    now++;
+    fx.update(now);
+  }
+  return micros() - start;
+}
+
+void printResult(const __FlashStringHelper *effect, const __FlashStringHelper *form, unsigned long elapsed)
+{
+  Serial.print(effect);
+  Serial.print(',');
+  Serial.print(form);
+  Serial.print(',');
+  Serial.println((unsigned long)((elapsed * 1000.0) / NUM_FRAMES));
+}
+
+template <Effect E>
+void benchmarkEffect(const __FlashStringHelper *name)
+{
+#if FORMS != 1
+  NeoPixelEffects runtime(leds, E, 0, NUM_LEDS - 1, NUM_LEDS / 8, 0, CRGB::Cyan, true, FORWARD);
+  printResult(name, F("runtime"), runFrames(runtime));
+#endif
+#if FORMS != 0
+  NeoPixelEffectsCompiled<E> compiled(leds, 0, NUM_LEDS - 1, NUM_LEDS / 8, 0, CRGB::Cyan, true, FORWARD);
+  printResult(name, F("compiled"), runFrames(compiled));
+#endif
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  Serial.println(F("effect,form,ns/frame"));
+  benchmarkEffect<COMET>(F("COMET"));
+  benchmarkEffect<CHASE>(F("CHASE"));
+  benchmarkEffect<STROBE>(F("STROBE"));
+  benchmarkEffect<SINEWAVE>(F("SINEWAVE"));
+}
+
+void loop() {
+}
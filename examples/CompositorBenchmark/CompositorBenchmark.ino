@@ -0,0 +1,82 @@
+// NeoPixel Effects library compositor benchmark
+// released under the GPLv3 license
+//
+// Blends four layers of 300 pixels, the load of a typical layered strip,
+// and prints the cost of a frame as CSV: once per blend mode for the
+// compositing alone, then with the four effects rendering every frame.
+// The last column is the share of a 100 fps frame budget used.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsCompositor.h"
+#include "FastLED.h"
+
+#define NUM_LEDS           300
+#define NUM_LAYERS           4
+#define NUM_FRAMES         500
+
+CRGB leds[NUM_LEDS];
+CRGB layers[NUM_LAYERS][NUM_LEDS];
+
+NeoPixelEffects effects[NUM_LAYERS];
+const Effect layer_effects[NUM_LAYERS] = {RAINBOWWAVE, PULSE, COMET, CHASE};
+
+const char *mode_names[NUM_BLENDMODE] = {"NORMAL", "ADD", "MAX", "MULTIPLY", "ALPHA"};
+
+void printResult(const char *name, unsigned long elapsed)
+{
+  float us_frame = (float)elapsed / NUM_FRAMES;
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(us_frame, 2);
+  Serial.print(',');
+  Serial.print(1000000.0 / us_frame, 0);
+  Serial.print(',');
+  Serial.println(us_frame / 100.0, 2);  // A 100 fps frame lasts 10000 us
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  for (int i = 0; i < NUM_LAYERS; i++) {
+    effects[i] = NeoPixelEffects(layers[i], layer_effects[i], 0, NUM_LEDS - 1, 20, 0, CHSV(i * 64, 255, 255), true, FORWARD);
+    for (unsigned long t = 0; t < 10; t++) {
+      effects[i].update(t);
+    }
+  }
+
+  Serial.println(F("test,us/frame,fps,% of 100 fps"));
+
+  // Compositing only: the layers hold a frame each and are blended again
+  // every frame, the bottom one opaque and the others in the mode tested
+  for (int mode = 0; mode < NUM_BLENDMODE; mode++) {
+    NeoPixelEffectsCompositor compositor(leds, NUM_LEDS);
+    compositor.addLayer(NULL, layers[0]);
+    for (int i = 1; i < NUM_LAYERS; i++) {
+      compositor.addLayer(NULL, layers[i], (BlendMode)mode, 192);
+    }
+    unsigned long start = micros();
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      compositor.invalidate();
+      compositor.update(frame);
+    }
+    printResult(mode_names[mode], micros() - start);
+  }
+
+  // Rendering and compositing, with every layer changing every frame
+  NeoPixelEffectsCompositor compositor(leds, NUM_LEDS);
+  compositor.addLayer(&effects[0], layers[0]);
+  compositor.addLayer(&effects[1], layers[1], BLEND_MULTIPLY);
+  compositor.addLayer(&effects[2], layers[2], BLEND_ALPHA);
+  compositor.addLayer(&effects[3], layers[3], BLEND_ADD, 64);
+  unsigned long now = 100;
+  unsigned long start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    now++;
+    compositor.update(now);
+  }
+  printResult("effects+composite", micros() - start);
+}
+
+void loop() {
+}
@@ -0,0 +1,124 @@
+// NeoPixel Effects library output correction benchmark
+// released under the GPLv3 license
+//
+// Corrects a rainbow frame for brightness, gamma and white balance and
+// prints the cost of a frame as CSV. The multi-pass version is how a sketch
+// usually does it: a gamma table, then nscale8() for brightness, then
+// nscale8() with the white balance. NeoPixelEffectsCorrection folds the
+// three into one table read per channel. The last column is the largest
+// difference from the exact result, in steps of the 8-bit output.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsCorrection.h"
+#include "FastLED.h"
+#include <math.h>
+
+#if defined(__AVR__)
+  #define NUM_LEDS          256
+#else
+  #define NUM_LEDS         1024
+#endif
+
+#define NUM_FRAMES          200
+#define GAMMA               2.6
+#define BRIGHTNESS          160
+
+const CRGB balance(255, 176, 240);
+
+CRGB leds[NUM_LEDS];
+CRGB out[NUM_LEDS];
+uint8_t gamma8[256];
+NeoPixelEffectsCorrection correction;
+
+void multiPass()
+{
+  for (int i = 0; i < NUM_LEDS; i++) {
+    out[i].r = gamma8[leds[i].r];
+    out[i].g = gamma8[leds[i].g];
+    out[i].b = gamma8[leds[i].b];
+  }
+  for (int i = 0; i < NUM_LEDS; i++) {
+    out[i].nscale8(BRIGHTNESS);
+  }
+  for (int i = 0; i < NUM_LEDS; i++) {
+    out[i].nscale8(balance);
+  }
+}
+
+// Largest distance of out[] from the unrounded correction of leds[]
+float maxError()
+{
+  float worst = 0;
+  for (int i = 0; i < NUM_LEDS; i++) {
+    for (int c = 0; c < 3; c++) {
+      float exact = pow(leds[i].raw[c] / 255.0, GAMMA) * BRIGHTNESS * (balance.raw[c] / 255.0);
+      float error = fabs(out[i].raw[c] - exact);
+      if (error > worst) {
+        worst = error;
+      }
+    }
+  }
+  return worst;
+}
+
+void printResult(const char *name, unsigned long elapsed)
+{
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(NUM_LEDS);
+  Serial.print(',');
+  Serial.print((float)elapsed / NUM_FRAMES, 2);
+  Serial.print(',');
+  Serial.print((elapsed * 1000.0) / NUM_FRAMES / NUM_LEDS, 2);
+  Serial.print(',');
+  Serial.println(maxError(), 2);
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  for (int v = 0; v < 256; v++) {
+    gamma8[v] = (uint8_t)(pow(v / 255.0, GAMMA) * 255.0 + 0.5);
+  }
+  NeoPixelEffects rainbow(leds, RAINBOWWAVE, 0, NUM_LEDS - 1, 1, 0, CRGB::White, true, FORWARD);
+  rainbow.update(1);
+
+  correction.setGamma(GAMMA);
+  correction.setBrightness(BRIGHTNESS);
+  correction.setWhiteBalance(balance);
+
+  Serial.println(F("method,pixels,us/frame,ns/pixel,max error"));
+
+  unsigned long start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    multiPass();
+  }
+  printResult("multi-pass", micros() - start);
+
+  // The first apply() builds the tables; time that separately
+  start = micros();
+  correction.apply(leds, out, NUM_LEDS);
+  unsigned long rebuild = micros() - start;
+
+  start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    correction.apply(leds, out, NUM_LEDS);
+  }
+  printResult("table", micros() - start);
+
+#if NEOPIXELEFFECTS_DITHER
+  correction.setDither(true);
+  start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    correction.apply(leds, out, NUM_LEDS);
+  }
+  printResult("table+dither", micros() - start);
+#endif
+
+  Serial.print(F("table rebuild,us,"));
+  Serial.println(rebuild);
+}
+
+void loop() {
+}
@@ -0,0 +1,53 @@
+// NeoPixel Effects library partial update example
+// released under the GPLv3 license
+//
+// Streams only the pixels that changed since the last frame over serial,
+// for transports that can update part of a strip such as a host side
+// simulator or a network bridge. Each span is sent as the byte 'S', the
+// first pixel and the pixel count as 16-bit little endian values, then the
+// RGB bytes of the pixels. A frame ends with the byte 'F'.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsManager.h"
+#include "FastLED.h"
+
+#define NUM_LEDS      300
+
+CRGB leds[NUM_LEDS];
+
+NeoPixelEffects effects[4];
+NeoPixelEffectsManager manager;
+
+void writeWord(uint16_t value)
+{
+  Serial.write(value & 0xFF);
+  Serial.write(value >> 8);
+}
+
+void sendSpan(int first, int last)
+{
+  Serial.write('S');
+  writeWord(first);
+  writeWord(last - first + 1);
+  Serial.write((const uint8_t *)&leds[first], (last - first + 1) * sizeof(CRGB));
+}
+
+void setup() {
+  Serial.begin(1000000);
+
+  // A slow fill and a one-shot comet change a few pixels per frame, and the
+  // background segment is drawn once and never again
+  effects[0] = NeoPixelEffects(leds, FILLIN, 0, 99, 1, 40, CRGB::Orange, false, FORWARD);
+  effects[1] = NeoPixelEffects(leds, COMET, 100, 199, 6, 20, CRGB::Cyan, false, FORWARD);
+  effects[2] = NeoPixelEffects(leds, NONE, 200, 279, 1, 0, CRGB::Black, false, FORWARD);
+  effects[2].fill_gradient(CRGB::Purple, CRGB::Blue);
+  effects[3] = NeoPixelEffects(leds, PULSE, 280, 299, 1, 30, CRGB::Green, true, FORWARD);
+  manager.add(effects, 4);
+}
+
+void loop() {
+  if (manager.update()) {
+    manager.writeDirtySpans(sendSpan);
+    Serial.write('F');
+  }
+}
@@ -2,7 +2,12 @@
 // released under the GPLv3 license
 
 #include "NeoPixelEffects.h"
+#include "NeoPixelEffectsParticles.h"
 #include "FastLED.h"
+
+#if !NEOPIXELEFFECTS_PARTICLES
+  #error "Build with NEOPIXELEFFECTS_PARTICLES=1, the default"
+#endif
 #ifdef __AVR__
   #include <avr/power.h>
 #endif
@@ -12,20 +17,22 @@
 
 CRGB leds[NUM_LEDS];
 
-// Firework stars parameters - currently unable to modify mortar params
+// Firework stars parameters - the mortar is always white
 Effect effectType = FIREWORK; // Effect
 int rangeStart = 0;
 int rangeEnd = NUM_LEDS - 1;
-int stars_aoe = 7;
+int stars_aoe = 7;              // How far the stars spread
 unsigned long updateDelay = 25; // millis
-bool m_looping = false;         // Currently unused, auto-noloop
-bool m_dir = FORWARD;           // Currently unused, auto-forward
+bool m_looping = true;          // Launch again once the stars burn out
+bool m_dir = FORWARD;           // Launch from rangeStart
 CRGB stars_orange = CRGB{200, 133, 0};
 
 NeoPixelEffects fw = NeoPixelEffects(leds, effectType, rangeStart, rangeEnd, stars_aoe, updateDelay, stars_orange, m_looping, m_dir);
+NeoPixelEffectsParticles stars;
 
 void setup() {
   FastLED.addLeds<NEOPIXEL,DATA_PIN>(leds, NUM_LEDS);
+  fw.setParticles(&stars);
 
   Serial.begin(9600);
 }
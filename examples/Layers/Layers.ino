@@ -0,0 +1,39 @@
+// NeoPixel Effects library layered effects example
+// released under the GPLv3 license
+//
+// Runs a comet and a fill over a pulsing background on the same pixels.
+// Each effect draws into its own layer buffer and the compositor blends
+// them into the strip, so the effects never overwrite each other.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsCompositor.h"
+#include "FastLED.h"
+
+#define DATA_PIN            A0
+#define NUM_LEDS            60
+
+CRGB leds[NUM_LEDS];
+CRGB background[NUM_LEDS];
+CRGB comet[NUM_LEDS];
+CRGB fill[NUM_LEDS / 2];
+
+NeoPixelEffects pulse_effect(background, PULSE, 0, NUM_LEDS - 1, 1, 20, CRGB::Blue, true, FORWARD);
+NeoPixelEffects comet_effect(comet, COMET, 0, NUM_LEDS - 1, 10, 15, CRGB::Orange, true, FORWARD);
+NeoPixelEffects fill_effect(fill, FILLIN, 0, NUM_LEDS / 2 - 1, 1, 100, CRGB::Red, false, FORWARD);
+
+NeoPixelEffectsCompositor compositor(leds, NUM_LEDS);
+
+void setup() {
+  FastLED.addLeds<NEOPIXEL, DATA_PIN>(leds, NUM_LEDS);
+
+  compositor.addLayer(&pulse_effect, background);
+  compositor.addLayer(&comet_effect, comet, BLEND_ALPHA);
+  // The fill covers the middle half of the strip at half strength
+  compositor.addTile(&fill_effect, fill, NUM_LEDS / 4, NUM_LEDS / 2, BLEND_ADD, 128);
+}
+
+void loop() {
+  if (compositor.update()) {
+    FastLED.show();
+  }
+}
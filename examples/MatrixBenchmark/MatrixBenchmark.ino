@@ -0,0 +1,112 @@
+// NeoPixel Effects library matrix mapping benchmark
+// released under the GPLv3 license
+//
+// Runs effects over a serpentine matrix and prints the cost of a frame as
+// CSV: drawn straight into the LEDs as if they were one strip, drawn in
+// logical order and copied to the LEDs through a NeoPixelEffectsMap, and
+// the rainbow and a wave laid out in rings with a phase table. Only the
+// dirty range is copied. The last column is the mapping cost per pixel.
+// On AVR, build the whole library with NEOPIXELEFFECTS_CACHE set to 1, e.g.
+// with build_flags = -DNEOPIXELEFFECTS_CACHE=1 in PlatformIO.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsMap.h"
+#include "FastLED.h"
+
+#if !NEOPIXELEFFECTS_CACHE
+  #error "Build with NEOPIXELEFFECTS_CACHE=1, the default except in compact builds"
+#endif
+
+#if defined(__AVR__)
+  #define WIDTH              16
+  #define HEIGHT             16
+#else
+  #define WIDTH              32
+  #define HEIGHT             32
+#endif
+
+#define NUM_LEDS    (WIDTH * HEIGHT)
+#define NUM_FRAMES          500
+
+CRGB leds[NUM_LEDS];
+CRGB logical[NUM_LEDS];
+uint16_t table[NUM_LEDS];
+uint8_t phases[NUM_LEDS];
+
+NeoPixelEffectsMap matrix(table, NUM_LEDS);
+NeoPixelEffectsCache cache(phases, NUM_LEDS);
+
+unsigned long run(NeoPixelEffects &effect, bool mapped)
+{
+  unsigned long start = micros();
+  for (unsigned long frame = 1; frame <= NUM_FRAMES; frame++) {
+    effect.update(frame);
+    // Only the pixels the effect changed need copying
+    int first, last;
+    if (mapped && effect.getDirtyRange(first, last)) {
+      matrix.apply(logical, leds, first, last);
+      effect.clearDirty();
+    }
+  }
+  return micros() - start;
+}
+
+void printResult(const char *name, unsigned long raw, unsigned long mapped)
+{
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(NUM_LEDS);
+  Serial.print(',');
+  Serial.print((float)raw / NUM_FRAMES, 2);
+  Serial.print(',');
+  Serial.print((float)mapped / NUM_FRAMES, 2);
+  Serial.print(',');
+  Serial.println(((float)mapped - raw) * 1000.0 / NUM_FRAMES / NUM_LEDS, 2);
+}
+
+void benchmark(Effect effect, const char *name, int aoe)
+{
+  NeoPixelEffects raw(leds, effect, 0, NUM_LEDS - 1, aoe, 0, CRGB::Cyan, true, FORWARD);
+  NeoPixelEffects mapped(logical, effect, 0, NUM_LEDS - 1, aoe, 0, CRGB::Cyan, true, FORWARD);
+  unsigned long raw_time = run(raw, false);
+  printResult(name, raw_time, run(mapped, true));
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  NeoPixelEffectsMap::serpentine(table, WIDTH, HEIGHT);
+
+  Serial.println(F("effect,pixels,linear us/frame,mapped us/frame,ns/pixel for mapping"));
+  benchmark(COMET, "COMET", WIDTH);
+  benchmark(RAINBOWWAVE, "RAINBOWWAVE", 1);
+  benchmark(SINEWAVE, "SINEWAVE", 1);
+
+  // The same rainbow and wave drawn from tables, first along the range and
+  // then in rings from the centre of the matrix
+  NeoPixelEffects raw(leds, RAINBOWWAVE, 0, NUM_LEDS - 1, 1, 0, CRGB::Cyan, true, FORWARD);
+  raw.setCache(&cache);
+  unsigned long raw_time = run(raw, false);
+  cache.keepphases = true;
+  cache.valid = false;
+  NeoPixelEffectsMap::matrixPhases(phases, WIDTH, HEIGHT, PHASE_RADIAL);
+  NeoPixelEffects rings(logical, RAINBOWWAVE, 0, NUM_LEDS - 1, 1, 0, CRGB::Cyan, true, FORWARD);
+  rings.setCache(&cache);
+  printResult("RAINBOWWAVE radial", raw_time, run(rings, true));
+
+  cache.keepphases = false;
+  cache.valid = false;
+  raw = NeoPixelEffects(leds, SINEWAVE, 0, NUM_LEDS - 1, 1, 0, CRGB::Cyan, true, FORWARD);
+  raw.setCache(&cache);
+  raw_time = run(raw, false);
+  cache.keepphases = true;
+  cache.valid = false;
+  NeoPixelEffectsMap::matrixPhases(phases, WIDTH, HEIGHT, PHASE_RADIAL);
+  rings = NeoPixelEffects(logical, SINEWAVE, 0, NUM_LEDS - 1, 1, 0, CRGB::Cyan, true, FORWARD);
+  rings.setCache(&cache);
+  printResult("SINEWAVE radial", raw_time, run(rings, true));
+}
+
+void loop() {
+}
@@ -0,0 +1,71 @@
+// NeoPixel Effects library output thread example
+// released under the GPLv3 license
+//
+// For Linux hosts driving a simulator or a network bridge. Effects render
+// as fast as they can while an output thread sends each finished frame to
+// a UDP port on this machine, or to a file with USE_FILE. Every second the
+// frames written, the frames dropped because the sink fell behind and the
+// latency from submit() to the end of the write are printed.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsManager.h"
+#include "NeoPixelEffectsOutput.h"
+#include "FastLED.h"
+
+#ifndef NEOPIXELEFFECTS_HAS_THREADS
+  #error "NeoPixelEffectsOutput needs std::thread"
+#endif
+
+#define NUM_LEDS      1200
+#define UDP_PORT      7777
+// #define USE_FILE   "frames.rgb"
+
+CRGB leds[NUM_LEDS];
+
+NeoPixelEffects effects[3];
+NeoPixelEffectsManager manager;
+
+// Without sockets the frames go to a file
+#if !defined(USE_FILE) && !defined(NEOPIXELEFFECTS_HAS_SOCKETS)
+  #define USE_FILE    "frames.rgb"
+#endif
+
+#ifdef USE_FILE
+NeoPixelEffectsFileSink sink(fopen(USE_FILE, "wb"));
+#else
+NeoPixelEffectsUdpSink sink("127.0.0.1", UDP_PORT);
+#endif
+
+NeoPixelEffectsOutput output(leds, NUM_LEDS, sink);
+
+unsigned long lastreport = 0;
+
+void setup() {
+  Serial.begin(115200);
+
+  effects[0] = NeoPixelEffects(leds, RAINBOWWAVE, 0, 399, 1, 10, CRGB::Red, true, FORWARD);
+  effects[1] = NeoPixelEffects(leds, COMET, 400, 799, 12, 5, CRGB::Cyan, true, FORWARD);
+  effects[2] = NeoPixelEffects(leds, SINEWAVE, 800, 1199, 1, 10, CRGB::Orange, true, REVERSE);
+  manager.add(effects, 3);
+}
+
+void loop() {
+  if (manager.update()) {
+    output.submit();
+  }
+
+  if (millis() - lastreport >= 1000) {
+    lastreport = millis();
+    Serial.print(F("frames "));
+    Serial.print(output.getFrames());
+    Serial.print(F(", dropped "));
+    Serial.print(output.getDroppedFrames());
+    Serial.print(F(", errors "));
+    Serial.print(output.getWriteErrors());
+    Serial.print(F(", latency us avg "));
+    Serial.print(output.getAverageLatency());
+    Serial.print(F(" max "));
+    Serial.println(output.getMaxLatency());
+    output.resetStats();
+  }
+}
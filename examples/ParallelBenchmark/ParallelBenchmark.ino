@@ -0,0 +1,72 @@
+// NeoPixel Effects library parallel rendering benchmark
+// released under the GPLv3 license
+//
+// Splits a large pixel buffer into segments running a mix of cheap and
+// expensive effects, then renders them with 1 up to every available thread
+// and prints frames per second and speedup over a single thread as CSV.
+// Needs a toolchain with std::thread, such as a Linux host or an ESP32.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsParallel.h"
+#include "FastLED.h"
+
+#ifndef NEOPIXELEFFECTS_HAS_THREADS
+  #error "This example needs std::thread support"
+#endif
+
+#if defined(ESP32)
+  #define NUM_LEDS         8192
+#else
+  #define NUM_LEDS        50000
+#endif
+
+#define NUM_SEGMENTS          500
+#define NUM_FRAMES          100
+
+CRGB leds[NUM_LEDS];
+
+NeoPixelEffects effects[NUM_SEGMENTS];
+
+const Effect mix[] = {STROBE, RAINBOWWAVE, CHASE, SINEWAVE, PULSE, COMET, TRIWAVE, GLOW};
+const int num_mix = sizeof(mix) / sizeof(mix[0]);
+
+unsigned long runFrames(NeoPixelEffectsParallel &renderer)
+{
+  unsigned long now = 0;
+  unsigned long start = micros();
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    now++;
+    renderer.update(now);
+  }
+  return micros() - start;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  int seglen = NUM_LEDS / NUM_SEGMENTS;
+  for (int i = 0; i < NUM_SEGMENTS; i++) {
+    effects[i] = NeoPixelEffects(leds, mix[i % num_mix], i * seglen, (i + 1) * seglen - 1, 8, 0, CHSV(i * 16, 255, 255), true, FORWARD);
+  }
+
+  Serial.println(F("threads,fps,speedup"));
+  unsigned int cores = std::thread::hardware_concurrency();
+  float single_fps = 0;
+  for (unsigned int threads = 1; threads <= max(cores, 1U); threads++) {
+    NeoPixelEffectsParallel renderer(effects, NUM_SEGMENTS, threads);
+    unsigned long elapsed = runFrames(renderer);
+    float fps = NUM_FRAMES * 1000000.0 / elapsed;
+    if (threads == 1) {
+      single_fps = fps;
+    }
+    Serial.print(threads);
+    Serial.print(',');
+    Serial.print(fps, 1);
+    Serial.print(',');
+    Serial.println(fps / single_fps, 2);
+  }
+}
+
+void loop() {
+}
@@ -0,0 +1,70 @@
+// NeoPixel Effects library particle pool benchmark
+// released under the GPLv3 license
+//
+// Keeps a NeoPixelEffectsParticles pool filled to a range of particle
+// counts, moves and draws it over a strip and prints the cost per frame
+// and per particle as CSV, followed by the RAM the pool takes. The
+// Benchmark example times the FIREWORK and SPARKLEFILL effects built on it.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsParticles.h"
+#include "FastLED.h"
+
+#define NUM_LEDS            300
+#define NUM_FRAMES          200
+
+CRGB leds[NUM_LEDS];
+NeoPixelEffectsParticles particles;
+
+const int counts[] = {16, 32, 64, 128, 256};
+const int num_counts = sizeof(counts) / sizeof(counts[0]);
+
+// Tops the pool up to count particles spread over the strip
+void refill(int count)
+{
+  while (particles.getCount() < count) {
+    long position = random(NUM_LEDS * 256L);
+    int velocity = random(-256, 257);
+    particles.spawn(position, velocity, CRGB::Orange, random(1, 8));
+  }
+}
+
+unsigned long benchmarkParticles(int count)
+{
+  particles.clear();
+  unsigned long elapsed = 0;
+  for (int frame = 0; frame < NUM_FRAMES; frame++) {
+    refill(count);
+    unsigned long start = micros();
+    fill_solid(leds, NUM_LEDS, CRGB::Black);
+    particles.step(-2, 20, NUM_LEDS);
+    particles.render(leds, NUM_LEDS, false);
+    elapsed += micros() - start;
+  }
+  return elapsed;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  Serial.print(F("sizeof(NeoPixelEffectsParticles) = "));
+  Serial.print((unsigned int)sizeof(NeoPixelEffectsParticles));
+  Serial.print(F(" bytes for "));
+  Serial.print(particles.getCapacity());
+  Serial.println(F(" particles"));
+  Serial.println();
+
+  Serial.println(F("particles,ns/frame,ns/particle"));
+  for (int c = 0; c < num_counts && counts[c] <= particles.getCapacity(); c++) {
+    unsigned long ns_frame = (unsigned long)((benchmarkParticles(counts[c]) * 1000.0) / NUM_FRAMES);
+    Serial.print(counts[c]);
+    Serial.print(',');
+    Serial.print(ns_frame);
+    Serial.print(',');
+    Serial.println((float)ns_frame / counts[c], 2);
+  }
+}
+
+void loop() {
+}
@@ -0,0 +1,83 @@
+// NeoPixel Effects library effect pool benchmark
+// released under the GPLv3 license
+//
+// Runs the same short PULSE and STROBE segments as separate NeoPixelEffects
+// objects and as one NeoPixelEffectsPool, and prints the cost of a frame
+// for each as CSV. Segments alternate between FORWARD and REVERSE so their
+// levels differ. The last column checks that both drew the same pixels.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsPool.h"
+#include "FastLED.h"
+
+#if defined(__AVR__)
+  #define NUM_SEGMENTS       16
+  #define SEGMENT_LEDS        4
+#else
+  #define NUM_SEGMENTS     1000
+  #define SEGMENT_LEDS       10
+#endif
+
+#define NUM_LEDS    (NUM_SEGMENTS * SEGMENT_LEDS)
+#define NUM_FRAMES          500
+
+CRGB leds[NUM_LEDS];
+CRGB pooled[NUM_LEDS];
+NeoPixelEffects effects[NUM_SEGMENTS];
+
+CRGB segmentColor(int i)
+{
+  return CHSV(i * 7, 255, 255);
+}
+
+void benchmark(Effect effect, const char *name)
+{
+  NeoPixelEffectsPool *pool = new NeoPixelEffectsPool(pooled, effect, 0);
+  for (int i = 0; i < NUM_SEGMENTS; i++) {
+    int first = i * SEGMENT_LEDS;
+    bool dir = (i % 2 == 0) ? FORWARD : REVERSE;
+    effects[i] = NeoPixelEffects(leds, effect, first, first + SEGMENT_LEDS - 1, 1, 0, segmentColor(i), true, dir);
+    pool->add(first, first + SEGMENT_LEDS - 1, segmentColor(i), dir);
+  }
+
+  unsigned long start = micros();
+  for (unsigned long frame = 1; frame <= NUM_FRAMES; frame++) {
+    for (int i = 0; i < NUM_SEGMENTS; i++) {
+      effects[i].update(frame);
+    }
+  }
+  unsigned long objects = micros() - start;
+
+  start = micros();
+  for (unsigned long frame = 1; frame <= NUM_FRAMES; frame++) {
+    pool->update(frame);
+  }
+  unsigned long pool_time = micros() - start;
+
+  bool same = memcmp(leds, pooled, sizeof(leds)) == 0;
+  delete pool;
+
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(NUM_SEGMENTS);
+  Serial.print(',');
+  Serial.print((float)objects / NUM_FRAMES, 2);
+  Serial.print(',');
+  Serial.print((float)pool_time / NUM_FRAMES, 2);
+  Serial.print(',');
+  Serial.print((float)objects / pool_time, 1);
+  Serial.print(',');
+  Serial.println(same ? F("yes") : F("NO"));
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  Serial.println(F("effect,segments,objects us/frame,pool us/frame,speedup,same pixels"));
+  benchmark(PULSE, "PULSE");
+  benchmark(STROBE, "STROBE");
+}
+
+void loop() {
+}
@@ -0,0 +1,73 @@
+// NeoPixel Effects library power limiting example
+// released under the GPLv3 license
+//
+// A white PULSE and a white STROBE share a strip on a 2 A supply. At their
+// peaks together they would draw over 9 A, so the limiter dims those frames
+// to fit the budget. Once a second the sketch prints the estimate, the
+// dimmed estimate and, for comparison, the current counted from the pixels
+// actually sent. Build the whole library with NEOPIXELEFFECTS_POWER set to
+// 1, e.g. with build_flags = -DNEOPIXELEFFECTS_POWER=1 in PlatformIO.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsManager.h"
+#include "NeoPixelEffectsCorrection.h"
+#include "NeoPixelEffectsPower.h"
+#include "FastLED.h"
+
+#if !NEOPIXELEFFECTS_POWER
+  #error "Build with NEOPIXELEFFECTS_POWER=1"
+#endif
+
+#define DATA_PIN      6
+#define NUM_LEDS      150
+#define BUDGET_MA     2000
+
+CRGB leds[NUM_LEDS];    // Drawn by the effects
+CRGB out[NUM_LEDS];     // Sent to the strip
+
+NeoPixelEffects effects[2];
+NeoPixelEffectsManager manager;
+NeoPixelEffectsCorrection correction;
+NeoPixelEffectsPowerLimiter limiter(manager, correction, NUM_LEDS, BUDGET_MA);
+
+unsigned long lastreport = 0;
+
+// Brute force estimate over the whole strip, with the library's model
+unsigned long countCurrent()
+{
+  unsigned long load = 0;
+  for (int i = 0; i < NUM_LEDS; i++) {
+    load += out[i].r + out[i].g + out[i].b;
+  }
+  return (load * NEOPIXELEFFECTS_CHANNEL_MA + 127) / 255 + (unsigned long)NUM_LEDS * NEOPIXELEFFECTS_IDLE_MA;
+}
+
+void setup() {
+  FastLED.addLeds<NEOPIXEL, DATA_PIN>(out, NUM_LEDS);
+  Serial.begin(115200);
+
+  effects[0] = NeoPixelEffects(leds, PULSE, 0, 74, 1, 10, CRGB::White, true, FORWARD);
+  effects[1] = NeoPixelEffects(leds, STROBE, 75, 149, 1, 250, CRGB::White, true, FORWARD);
+  manager.add(effects, 2);
+
+  Serial.println(F("estimate mA,limited mA,counted mA,limit"));
+}
+
+void loop() {
+  if (manager.update()) {
+    limiter.update();
+    correction.apply(leds, out, NUM_LEDS);
+    FastLED.show();
+  }
+
+  if (millis() - lastreport >= 1000) {
+    lastreport = millis();
+    Serial.print(limiter.getCurrent());
+    Serial.print(',');
+    Serial.print(limiter.getLimitedCurrent());
+    Serial.print(',');
+    Serial.print(countCurrent());
+    Serial.print(',');
+    Serial.println(correction.getLimit());
+  }
+}
@@ -0,0 +1,107 @@
+// NeoPixel Effects library recording benchmark
+// released under the GPLv3 license
+//
+// For hosts with a file system. Records every effect for a few hundred
+// frames, plays each recording back from memory and prints, as CSV, the
+// raw and recorded size, the compression ratio, and the cost per frame of
+// rendering the effect live and of playing the recording.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsParticles.h"
+#include "NeoPixelEffectsRecording.h"
+#include "FastLED.h"
+
+#if defined(__AVR__)
+  #error "RecordingBenchmark needs a host with a file system"
+#endif
+
+#define NUM_LEDS            300
+#define NUM_FRAMES          500
+
+CRGB leds[NUM_LEDS];
+NeoPixelEffectsParticles particles;
+
+const char *effect_names[NUM_EFFECT] = {
+  "NONE", "COMET", "LARSON", "CHASE", "PULSE", "STATIC", "FADE", "FILLIN",
+  "GLOW", "RAINBOWWAVE", "STROBE", "SINEWAVE", "RANDOM", "TALKING", "TRIWAVE",
+  "FIREWORK", "SPARKLEFILL"
+};
+
+// Renders NUM_FRAMES frames of effect, recording them to file if it is set.
+// Returns the time spent rendering.
+unsigned long renderEffect(Effect effect, FILE *file)
+{
+  NeoPixelEffects fx = NeoPixelEffects(leds, effect, 0, NUM_LEDS - 1, 8, 1, CRGB::Cyan, true, FORWARD);
+#if NEOPIXELEFFECTS_PARTICLES
+  fx.setParticles(&particles);
+#endif
+  fx.clear();
+
+  NeoPixelEffectsRecorder recorder(leds, NUM_LEDS);
+  if (file != NULL) {
+    recorder.begin(file, 20);
+  }
+
+  unsigned long elapsed = 0;
+  for (unsigned long now = 0; now < NUM_FRAMES; now++) {
+    // One-shot effects pause themselves; restart them in place
+    if (fx.getStatus() != ACTIVE) {
+      fx.setEffect(effect);
+    }
+    unsigned long start = micros();
+    fx.update(now);
+    elapsed += micros() - start;
+    if (file != NULL) {
+      recorder.record();
+    }
+  }
+  if (file != NULL) {
+    recorder.end();
+  }
+  return elapsed;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial) {}
+
+  Serial.println(F("effect,raw bytes,recorded bytes,ratio,ns/frame live,ns/frame playback"));
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    unsigned long live = renderEffect((Effect)e, NULL);
+
+    FILE *file = tmpfile();
+    if (file == NULL) {
+      Serial.println(F("tmpfile() failed"));
+      return;
+    }
+    renderEffect((Effect)e, file);
+    long size = ftell(file);
+    uint8_t *data = new uint8_t[size];
+    rewind(file);
+    fread(data, 1, size, file);
+    fclose(file);
+
+    NeoPixelEffectsPlayer player(leds, NUM_LEDS);
+    player.begin(data, size);
+    unsigned long start = micros();
+    while (player.nextFrame()) {}
+    unsigned long playback = micros() - start;
+    delete[] data;
+
+    unsigned long raw = (unsigned long)NUM_FRAMES * NUM_LEDS * sizeof(CRGB);
+    Serial.print(effect_names[e]);
+    Serial.print(',');
+    Serial.print(raw);
+    Serial.print(',');
+    Serial.print(size);
+    Serial.print(',');
+    Serial.print((float)raw / size, 1);
+    Serial.print(',');
+    Serial.print((unsigned long)((live * 1000.0) / NUM_FRAMES));
+    Serial.print(',');
+    Serial.println((unsigned long)((playback * 1000.0) / NUM_FRAMES));
+  }
+}
+
+void loop() {
+}
@@ -2,7 +2,12 @@
 // released under the GPLv3 license
 
 #include "NeoPixelEffects.h"
+#include "NeoPixelEffectsParticles.h"
 #include "FastLED.h"
+
+#if !NEOPIXELEFFECTS_PARTICLES
+  #error "Build with NEOPIXELEFFECTS_PARTICLES=1, the default"
+#endif
 #ifdef __AVR__
   #include <avr/power.h>
 #endif
@@ -12,16 +17,18 @@
 
 CRGB leds[NUM_LEDS];
 
-Effect effectType = SPARKLETRAIL;  // Effect
+Effect effectType = SPARKLEFILL;   // Effect
 int rangeStart = 0;          // # pixel (> 0 and < NUMPIXELS - 2)
 int rangeEnd = NUM_LEDS - 1;           // # pixel (> 1 and < NUMPIXELS - 1)
 unsigned long updateDelay = 250;   // millis
 CRGB grey = CRGB(75, 75, 75);
 
 NeoPixelEffects effect = NeoPixelEffects(leds, effectType, rangeStart, rangeEnd, 1, updateDelay, grey, true, true);
+NeoPixelEffectsParticles sparkles;
 
 void setup() {
   FastLED.addLeds<NEOPIXEL,DATA_PIN>(leds, NUM_LEDS);
+  effect.setParticles(&sparkles);
 
   Serial.begin(9600);
 }
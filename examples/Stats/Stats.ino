@@ -0,0 +1,51 @@
+// NeoPixel Effects library instrumentation example
+// released under the GPLv3 license
+//
+// Runs a few segments of different sizes and prints, every five seconds,
+// how often each was called and rendered, how long its frames took, how
+// late they ran and how many ticks it missed, as CSV. Build the whole
+// library with NEOPIXELEFFECTS_STATS set to 1, e.g. with
+// build_flags = -DNEOPIXELEFFECTS_STATS=1 in PlatformIO; defining it in the
+// sketch alone does not change how the library is compiled.
+
+#include "NeoPixelEffects.h"
+#include "NeoPixelEffectsManager.h"
+#include "FastLED.h"
+
+#if !NEOPIXELEFFECTS_STATS
+  #error "Build with NEOPIXELEFFECTS_STATS=1"
+#endif
+
+#define DATA_PIN      6
+#define NUM_LEDS      300
+
+CRGB leds[NUM_LEDS];
+
+NeoPixelEffects effects[4];
+NeoPixelEffectsManager manager;
+
+unsigned long lastreport = 0;
+
+void setup() {
+  FastLED.addLeds<NEOPIXEL, DATA_PIN>(leds, NUM_LEDS);
+  Serial.begin(115200);
+
+  effects[0] = NeoPixelEffects(leds, STATIC, 0, 199, 1, 20, CRGB::White, true, FORWARD);
+  effects[1] = NeoPixelEffects(leds, RAINBOWWAVE, 200, 259, 1, 10, CRGB::Red, true, FORWARD);
+  effects[2] = NeoPixelEffects(leds, COMET, 260, 289, 6, 15, CRGB::Cyan, true, REVERSE);
+  effects[3] = NeoPixelEffects(leds, PULSE, 290, 299, 1, 30, CRGB::Green, true, FORWARD);
+  manager.add(effects, 4);
+}
+
+void loop() {
+  if (manager.update()) {
+    FastLED.show();
+  }
+
+  if (millis() - lastreport >= 5000) {
+    lastreport = millis();
+    manager.printStats(Serial);
+    Serial.println();
+    manager.resetStats();
+  }
+}
@@ -0,0 +1,84 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Stand-in for the parts of the Arduino core the library and its examples
+// use, so they build and run on a desktop host. Serial writes to stdout.
+
+#ifndef NEOPIXELEFFECTS_HOST_ARDUINO_H
+#define NEOPIXELEFFECTS_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+
+class __FlashStringHelper;
+#define F(string_literal) ((const __FlashStringHelper *)(string_literal))
+
+#define A0 14
+
+// Milliseconds and microseconds since the program started. Once a test
+// calls setMillis(), millis() returns the simulated clock instead, which
+// only moves with setMillis() and delay(). micros() always runs in real
+// time so the benchmarks can time themselves.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void setMillis(unsigned long ms);
+void yield();
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c);
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    size_t print(const __FlashStringHelper *s);
+    size_t print(const char *s);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = 10);
+    size_t print(int value, int base = 10);
+    size_t print(unsigned int value, int base = 10);
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int digits = 2);
+
+    template <class T> size_t println(T value) { return print(value) + println(); }
+    template <class T> size_t println(T value, int format) { return print(value, format) + println(); }
+    size_t println();
+};
+
+class HardwareSerial : public Print {
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+template <class A, class B> static inline auto min(A a, B b) -> decltype(a + b) { return (a < b) ? a : b; }
+template <class A, class B> static inline auto max(A a, B b) -> decltype(a + b) { return (a > b) ? a : b; }
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#endif
@@ -0,0 +1,276 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Stand-in for the parts of FastLED the library and its examples use. The
+// 8-bit math, the waves and the random generator follow FastLED's portable
+// C versions. CHSV converts with a plain three-segment hue wheel, so
+// rainbow colours are close to, but not the same as, FastLED's.
+// FastLED.show() sends nothing.
+
+#ifndef NEOPIXELEFFECTS_HOST_FASTLED_H
+#define NEOPIXELEFFECTS_HOST_FASTLED_H
+
+#include <Arduino.h>
+
+#define FASTLED_SCALE8_FIXED 1
+
+typedef uint8_t fract8;
+
+static inline uint8_t scale8(uint8_t i, fract8 scale)
+{
+  return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+static inline uint8_t scale8_video(uint8_t i, fract8 scale)
+{
+  return (((int)i * (int)scale) >> 8) + ((i && scale) ? 1 : 0);
+}
+
+static inline uint8_t qadd8(uint8_t i, uint8_t j)
+{
+  unsigned int t = i + j;
+  return (t > 255) ? 255 : t;
+}
+
+static inline uint8_t qsub8(uint8_t i, uint8_t j)
+{
+  int t = i - j;
+  return (t < 0) ? 0 : t;
+}
+
+static inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amount_of_b)
+{
+  uint16_t partial = (uint16_t)a << 8;
+  partial += (uint16_t)b * amount_of_b;
+  partial -= (uint16_t)a * amount_of_b;
+  return partial >> 8;
+}
+
+static inline uint8_t triwave8(uint8_t in)
+{
+  if (in & 0x80) {
+    in = 255 - in;
+  }
+  return in << 1;
+}
+
+static inline uint8_t ease8InOutCubic(uint8_t i)
+{
+  uint8_t ii = scale8(i, i);
+  uint8_t iii = scale8(ii, i);
+  uint16_t r1 = (3 * (uint16_t)ii) - (2 * (uint16_t)iii);
+  return (r1 & 0x100) ? 255 : (uint8_t)r1;
+}
+
+static inline uint8_t cubicwave8(uint8_t in)
+{
+  return ease8InOutCubic(triwave8(in));
+}
+
+extern uint16_t rand16seed;
+
+static inline uint8_t random8()
+{
+  rand16seed = (rand16seed * 2053) + 13849;
+  return (uint8_t)(((uint8_t)rand16seed) + (uint8_t)(rand16seed >> 8));
+}
+
+static inline uint8_t random8(uint8_t lim)
+{
+  return ((uint16_t)random8() * lim) >> 8;
+}
+
+static inline uint8_t random8(uint8_t min, uint8_t lim)
+{
+  return min + random8(lim - min);
+}
+
+static inline uint16_t random16()
+{
+  rand16seed = (rand16seed * 2053) + 13849;
+  return rand16seed;
+}
+
+static inline uint16_t random16(uint16_t lim)
+{
+  return ((uint32_t)random16() * lim) >> 16;
+}
+
+static inline uint16_t random16(uint16_t min, uint16_t lim)
+{
+  return min + random16(lim - min);
+}
+
+static inline void random16_add_entropy(uint16_t entropy)
+{
+  rand16seed += entropy;
+}
+
+static inline void random16_set_seed(uint16_t seed)
+{
+  rand16seed = seed;
+}
+
+struct CHSV {
+  uint8_t h, s, v;
+
+  CHSV() {}
+  CHSV(uint8_t ih, uint8_t is, uint8_t iv) : h(ih), s(is), v(iv) {}
+};
+
+struct CRGB {
+  union {
+    struct {
+      uint8_t r, g, b;
+    };
+    uint8_t raw[3];
+  };
+
+  typedef uint32_t HTMLColorCode_t;
+  enum HTMLColorCode : uint32_t {
+    Black = 0x000000,
+    Blue = 0x0000FF,
+    Cyan = 0x00FFFF,
+    Green = 0x008000,
+    Magenta = 0xFF00FF,
+    Orange = 0xFFA500,
+    Purple = 0x800080,
+    Red = 0xFF0000,
+    White = 0xFFFFFF,
+    Yellow = 0xFFFF00
+  };
+
+  CRGB() {}
+  CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+  CRGB(uint32_t colorcode) : r((colorcode >> 16) & 0xFF), g((colorcode >> 8) & 0xFF), b(colorcode & 0xFF) {}
+  CRGB(const CHSV &hsv)
+  {
+    setHue(hsv.h);
+    if (hsv.s < 255) {
+      // Blend towards white
+      uint8_t white = 255 - hsv.s;
+      r = qadd8(scale8(r, hsv.s), white);
+      g = qadd8(scale8(g, hsv.s), white);
+      b = qadd8(scale8(b, hsv.s), white);
+    }
+    nscale8_video(hsv.v);
+  }
+
+  uint8_t &operator[](uint8_t x) { return raw[x]; }
+  const uint8_t &operator[](uint8_t x) const { return raw[x]; }
+
+  CRGB &setHue(uint8_t hue)
+  {
+    uint8_t offset = (hue % 85) * 3;
+    if (hue < 85) {
+      r = 255 - offset; g = offset; b = 0;
+    } else if (hue < 170) {
+      r = 0; g = 255 - offset; b = offset;
+    } else {
+      r = offset; g = 0; b = 255 - offset;
+    }
+    return *this;
+  }
+
+  CRGB &nscale8(uint8_t scale)
+  {
+    r = scale8(r, scale);
+    g = scale8(g, scale);
+    b = scale8(b, scale);
+    return *this;
+  }
+
+  CRGB &nscale8(const CRGB &scale)
+  {
+    r = scale8(r, scale.r);
+    g = scale8(g, scale.g);
+    b = scale8(b, scale.b);
+    return *this;
+  }
+
+  CRGB &nscale8_video(uint8_t scale)
+  {
+    r = scale8_video(r, scale);
+    g = scale8_video(g, scale);
+    b = scale8_video(b, scale);
+    return *this;
+  }
+
+  CRGB &fadeToBlackBy(uint8_t fadefactor)
+  {
+    return nscale8(255 - fadefactor);
+  }
+
+  CRGB &operator+=(const CRGB &rhs)
+  {
+    r = qadd8(r, rhs.r);
+    g = qadd8(g, rhs.g);
+    b = qadd8(b, rhs.b);
+    return *this;
+  }
+
+  CRGB &operator|=(const CRGB &rhs)
+  {
+    if (rhs.r > r) r = rhs.r;
+    if (rhs.g > g) g = rhs.g;
+    if (rhs.b > b) b = rhs.b;
+    return *this;
+  }
+
+  uint8_t getAverageLight() const
+  {
+    return (r + g + b) / 3;
+  }
+
+  operator bool() const
+  {
+    return r || g || b;
+  }
+};
+
+static inline bool operator==(const CRGB &lhs, const CRGB &rhs)
+{
+  return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b;
+}
+
+static inline bool operator!=(const CRGB &lhs, const CRGB &rhs)
+{
+  return !(lhs == rhs);
+}
+
+static inline CRGB blend(const CRGB &p1, const CRGB &p2, fract8 amount_of_p2)
+{
+  return CRGB(blend8(p1.r, p2.r, amount_of_p2), blend8(p1.g, p2.g, amount_of_p2), blend8(p1.b, p2.b, amount_of_p2));
+}
+
+static inline void fill_solid(CRGB *leds, int numToFill, const CRGB &color)
+{
+  for (int i = 0; i < numToFill; i++) {
+    leds[i] = color;
+  }
+}
+
+#define NEOPIXEL 1
+
+class CFastLED {
+  public:
+    template <int CHIPSET, int DATA_PIN> void addLeds(CRGB *leds, int count) { (void)leds; (void)count; }
+    void show() {}
+    void setBrightness(uint8_t scale) { (void)scale; }
+};
+
+extern CFastLED FastLED;
+
+#endif
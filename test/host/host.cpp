@@ -0,0 +1,144 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Host implementations of the Arduino and FastLED globals
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+CFastLED FastLED;
+uint16_t rand16seed = 1337;
+
+static const std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+static bool simulated = false;
+static unsigned long simulated_ms = 0;
+
+unsigned long millis()
+{
+  if (simulated) {
+    return simulated_ms;
+  }
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+}
+
+unsigned long micros()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+}
+
+void delay(unsigned long ms)
+{
+  if (simulated) {
+    simulated_ms += ms;
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+}
+
+void setMillis(unsigned long ms)
+{
+  simulated = true;
+  simulated_ms = ms;
+}
+
+void yield()
+{
+}
+
+long random(long howbig)
+{
+  return (howbig > 0) ? rand() % howbig : 0;
+}
+
+long random(long howsmall, long howbig)
+{
+  return (howbig > howsmall) ? howsmall + random(howbig - howsmall) : howsmall;
+}
+
+size_t Print::write(uint8_t c)
+{
+  return fputc(c, stdout) != EOF;
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0;
+  while (size--) {
+    written += write(*buffer++);
+  }
+  return written;
+}
+
+size_t Print::print(const __FlashStringHelper *s)
+{
+  return print((const char *)s);
+}
+
+size_t Print::print(const char *s)
+{
+  return write((const uint8_t *)s, strlen(s));
+}
+
+size_t Print::print(char c)
+{
+  return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+  return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+  if (base == 10 || value >= 0) {
+    char text[24];
+    snprintf(text, sizeof(text), base == 16 ? "%lx" : "%ld", value);
+    return print(text);
+  }
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+  char text[24];
+  snprintf(text, sizeof(text), base == 16 ? "%lx" : "%lu", value);
+  return print(text);
+}
+
+size_t Print::print(double value, int digits)
+{
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return print(text);
+}
+
+size_t Print::println()
+{
+  return print("\n");
+}
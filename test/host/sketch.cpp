@@ -0,0 +1,31 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Runs an example sketch on the host: setup() once, then loop() the number
+// of times given on the command line (once by default). The build passes
+// the sketch's path in SKETCH.
+
+#include <Arduino.h>
+#include SKETCH
+
+int main(int argc, char **argv)
+{
+  long loops = (argc > 1) ? atol(argv[1]) : 1;
+  setup();
+  for (long i = 0; i < loops; i++) {
+    loop();
+  }
+  return 0;
+}
@@ -0,0 +1,51 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks for the host tests. A failed CHECK() prints where it failed and
+// the test carries on; main() ends with return testResult(), which prints
+// a summary and is non-zero if anything failed.
+
+#ifndef NEOPIXELEFFECTS_TEST_H
+#define NEOPIXELEFFECTS_TEST_H
+
+#include <stdio.h>
+
+// Failures past this many are counted but not printed
+#define TEST_MAX_REPORTED 20
+
+static unsigned long test_checks = 0;
+static unsigned long test_failures = 0;
+
+#define CHECK(condition) CHECK_MSG(condition, "%s", "")
+
+#define CHECK_MSG(condition, ...) \
+  do { \
+    test_checks++; \
+    if (!(condition)) { \
+      if (++test_failures <= TEST_MAX_REPORTED) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #condition); \
+        fprintf(stderr, __VA_ARGS__); \
+        fprintf(stderr, "\n"); \
+      } \
+    } \
+  } while (0)
+
+static inline int testResult()
+{
+  printf("%lu checks, %lu failed\n", test_checks, test_failures);
+  return (test_failures == 0) ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Stalls every effect under TIMING_CATCHUP and checks that each frame
+// after a stall is the frame an on-time run of the same seed shows at
+// that tick, so replaying missed ticks, random effects included, keeps
+// the effect on its timeline.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsParticles.h>
+
+#define NUM_LEDS 61
+#define DELAY    10
+#define TICKS    600
+#define SEED     4242
+
+static CRGB leds[NUM_LEDS];
+static CRGB frames[TICKS][NUM_LEDS];
+static bool rendered[TICKS];
+
+// Calls are skipped on these ticks, each stall shorter than the catch-up limit
+static bool stalled(int tick)
+{
+  return (tick >= 20 && tick < 34) || (tick >= 70 && tick < 72) || (tick >= 150 && tick < 390) || (tick % 41 == 40);
+}
+
+static void start(NeoPixelEffects &fx, Effect effect, NeoPixelEffectsParticles &particles)
+{
+  fill_solid(leds, NUM_LEDS, CRGB::Black);
+  fx = NeoPixelEffects(leds, effect, 0, NUM_LEDS - 1, 7, DELAY, CRGB(180, 60, 250), true, FORWARD);
+#if NEOPIXELEFFECTS_PARTICLES
+  fx.setParticles(&particles);
+#else
+  (void)particles;
+#endif
+  fx.setTimingPolicy(TIMING_CATCHUP);
+  fx.setSeed(SEED);
+}
+
+static void checkEffect(Effect effect)
+{
+  NeoPixelEffectsParticles particles;
+  NeoPixelEffects fx;
+  const unsigned long t0 = 3000;
+
+  start(fx, effect, particles);
+  for (int tick = 0; tick < TICKS; tick++) {
+    rendered[tick] = fx.update(t0 + tick * DELAY);
+    memcpy(frames[tick], leds, sizeof(leds));
+  }
+
+  start(fx, effect, particles);
+  bool late = false;
+  for (int tick = 0; tick < TICKS; tick++) {
+    if (stalled(tick)) {
+      late = true;
+      continue;
+    }
+    // The first call after a stall comes a few ms into the tick
+    bool r = fx.update(t0 + tick * DELAY + (late ? 3 : 0));
+    late = false;
+    CHECK_MSG(r || !rendered[tick], "effect %d: tick %d not rendered", effect, tick);
+    CHECK_MSG(memcmp(frames[tick], leds, sizeof(leds)) == 0, "effect %d: tick %d differs from the on-time run", effect, tick);
+  }
+}
+
+int main()
+{
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    checkEffect((Effect)e);
+  }
+  return testResult();
+}
@@ -0,0 +1,225 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks NeoPixelEffectsCompositor against a reference that blends every
+// pixel of every layer from scratch in floating point, and each blend mode
+// on its own over every pair of channel values. Layers are full
+// length and tiles, in every blend mode, and are hidden, faded, switched
+// and drawn by hand on the way. Also checks that only pixels inside the
+// reported dirty range change and that an unchanged frame is skipped.
+
+#include "test.h"
+#include <math.h>
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsCompositor.h>
+
+#define NUM_LEDS   200
+#define NUM_LAYERS 6
+#define FRAMES     400
+
+struct TestLayer {
+  Effect effect;
+  int first;
+  int count;
+  BlendMode mode;
+  uint8_t alpha;
+};
+
+static const TestLayer setup_layers[NUM_LAYERS] = {
+  {PULSE, 0, NUM_LEDS, BLEND_NORMAL, 255},
+  {COMET, 37, 70, BLEND_ADD, 180},
+  {FILLIN, 150, 50, BLEND_MAX, 255},
+  {CHASE, 0, NUM_LEDS, BLEND_MULTIPLY, 200},
+  {SINEWAVE, 0, NUM_LEDS, BLEND_ALPHA, 128},
+  {NONE, 90, 33, BLEND_NORMAL, 99},   // Drawn by the sketch
+};
+
+static CRGB output[NUM_LEDS];
+static CRGB before[NUM_LEDS];
+static CRGB buffers[NUM_LAYERS][NUM_LEDS];
+static NeoPixelEffects effects[NUM_LAYERS];
+
+static BlendMode modes[NUM_LAYERS];
+static uint8_t alphas[NUM_LAYERS];
+static bool visible[NUM_LAYERS];
+static CRGB background;
+
+// One channel of the layer blended over what is below, in floating point
+static float blendChannel(float below, float layer, float cover, BlendMode mode)
+{
+  float blended;
+  switch (mode) {
+    case BLEND_ADD:
+      blended = fminf(below + layer, 255);
+      break;
+    case BLEND_MAX:
+      blended = fmaxf(below, layer);
+      break;
+    case BLEND_MULTIPLY:
+      blended = below * layer / 255;
+      break;
+    default:
+      blended = layer;
+      break;
+  }
+  return below + (blended - below) * cover / 255;
+}
+
+// Each blend rounds once, so a pixel may be off by one per layer on it
+static void checkAgainstReference(int frame)
+{
+  for (int p = 0; p < NUM_LEDS; p++) {
+    float c[3] = {(float)background.r, (float)background.g, (float)background.b};
+    int blended = 0;
+    for (int l = 0; l < NUM_LAYERS; l++) {
+      const TestLayer &layer = setup_layers[l];
+      if (!visible[l] || alphas[l] == 0 || p < layer.first || p >= layer.first + layer.count) {
+        continue;
+      }
+      const CRGB &src = buffers[l][p - layer.first];
+      float cover = alphas[l];
+      if (modes[l] == BLEND_ALPHA) {
+        cover = max(src.r, max(src.g, src.b)) * cover / 255;
+      }
+      for (int ch = 0; ch < 3; ch++) {
+        c[ch] = blendChannel(c[ch], src.raw[ch], cover, modes[l]);
+      }
+      blended++;
+    }
+    for (int ch = 0; ch < 3; ch++) {
+      int diff = abs(output[p].raw[ch] - (int)lroundf(c[ch]));
+      CHECK_MSG(diff <= blended, "frame %d, pixel %d: off by %d from the reference with %d layers", frame, p, diff, blended);
+    }
+  }
+}
+
+// One layer in each mode and at a range of alphas over every pair of
+// channel values, within one step of the exact blend
+static void checkBlendModes()
+{
+  static CRGB out[256];
+  static CRGB below[256];
+  static CRGB above[256];
+  static const uint8_t test_alphas[] = {0, 1, 64, 127, 128, 200, 254, 255};
+
+  for (int mode = BLEND_NORMAL; mode < NUM_BLENDMODE; mode++) {
+    for (unsigned int a = 0; a < sizeof(test_alphas); a++) {
+      for (int v = 0; v < 256; v++) {
+        NeoPixelEffectsCompositor single(out, 256);
+        single.addLayer(NULL, below);
+        single.addLayer(NULL, above, (BlendMode)mode, test_alphas[a]);
+        for (int i = 0; i < 256; i++) {
+          below[i] = CRGB(v, i, 255 - v);
+          above[i] = CRGB(i, v, (i * 7) & 255);
+        }
+        single.update(0);
+        for (int i = 0; i < 256; i++) {
+          float cover = test_alphas[a];
+          if (mode == BLEND_ALPHA) {
+            cover = max(above[i].r, max(above[i].g, above[i].b)) * cover / 255;
+          }
+          for (int ch = 0; ch < 3; ch++) {
+            float exact = blendChannel(below[i].raw[ch], above[i].raw[ch], cover, (BlendMode)mode);
+            int diff = abs(out[i].raw[ch] - (int)lroundf(exact));
+            CHECK_MSG(diff <= 1, "mode %d, alpha %d: %d over %d gives %d, exact %.2f", mode, test_alphas[a],
+                      above[i].raw[ch], below[i].raw[ch], out[i].raw[ch], exact);
+          }
+        }
+      }
+    }
+  }
+}
+
+int main()
+{
+  NeoPixelEffectsCompositor compositor(output, NUM_LEDS);
+  background = CRGB(5, 10, 20);
+  compositor.setBackground(background);
+  for (int l = 0; l < NUM_LAYERS; l++) {
+    const TestLayer &layer = setup_layers[l];
+    fill_solid(buffers[l], NUM_LEDS, CRGB::Black);
+    NeoPixelEffects *effect = NULL;
+    if (layer.effect != NONE) {
+      effects[l] = NeoPixelEffects(buffers[l], layer.effect, 0, layer.count - 1, 9, 10 + 3 * l,
+                                   CHSV(l * 40, 200, 255), true, (l & 1) ? REVERSE : FORWARD);
+      effect = &effects[l];
+    }
+    int index = (layer.first == 0 && layer.count == NUM_LEDS) ?
+                compositor.addLayer(effect, buffers[l], layer.mode, layer.alpha) :
+                compositor.addTile(effect, buffers[l], layer.first, layer.count, layer.mode, layer.alpha);
+    CHECK(index == l);
+    modes[l] = layer.mode;
+    alphas[l] = layer.alpha;
+    visible[l] = true;
+  }
+  CHECK(compositor.getCount() == NUM_LAYERS);
+  CHECK(compositor.addTile(NULL, buffers[0], 150, 51) == -1);
+
+  unsigned long now = 1000;
+  for (int frame = 0; frame < FRAMES; frame++) {
+    now += (frame % 31 == 0) ? 40 : 7;
+    if (frame == 50) {
+      compositor.setLayerVisible(1, false);
+      visible[1] = false;
+    } else if (frame == 80) {
+      compositor.setLayerVisible(1, true);
+      visible[1] = true;
+      compositor.setLayerAlpha(3, 0);
+      alphas[3] = 0;
+    } else if (frame == 120) {
+      compositor.setLayerAlpha(3, 77);
+      alphas[3] = 77;
+      compositor.setLayerMode(0, BLEND_ADD);
+      modes[0] = BLEND_ADD;
+    } else if (frame == 200) {
+      background = CRGB(40, 0, 0);
+      compositor.setBackground(background);
+    } else if (frame % 60 == 59) {
+      // The sketch draws its own layer and says so
+      for (int i = 0; i < setup_layers[5].count; i++) {
+        buffers[5][i] = CHSV(frame + i * 7, 255, 255);
+      }
+      compositor.invalidate();
+    }
+
+    memcpy(before, output, sizeof(output));
+    compositor.clearDirty();
+    bool changed = compositor.update(now);
+    checkAgainstReference(frame);
+
+    int first = NUM_LEDS;
+    int last = -1;
+    bool dirty = compositor.getDirtyRange(first, last);
+    CHECK_MSG(changed == dirty, "frame %d: update() and the dirty range disagree", frame);
+    for (int p = 0; p < NUM_LEDS; p++) {
+      if (p < first || p > last) {
+        CHECK_MSG(output[p] == before[p], "frame %d: pixel %d changed outside the dirty range", frame, p);
+      }
+    }
+  }
+
+  // With every effect paused nothing is recomposited
+  for (int l = 0; l < NUM_LAYERS; l++) {
+    effects[l].pause();
+  }
+  compositor.update(now + 100);
+  compositor.clearDirty();
+  int first, last;
+  CHECK(!compositor.update(now + 200));
+  CHECK(!compositor.getDirtyRange(first, last));
+
+  checkBlendModes();
+  return testResult();
+}
@@ -0,0 +1,203 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks the NeoPixelEffectsCorrection tables for every input value and
+// channel: identity at gamma 1, full brightness and white balance; gamma,
+// brightness and white balance against a double precision reference;
+// setLimit() never rounding a channel up; and, with dithering, the mean
+// of 256 frames matching the fraction the table holds.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsCorrection.h>
+#include <math.h>
+
+static CRGB ramp[256];
+static CRGB out[256];
+
+// Pixel v holds v in each channel
+static void fillRamp()
+{
+  for (int v = 0; v < 256; v++) {
+    ramp[v] = CRGB(v, v, v);
+  }
+}
+
+struct Setting {
+  float gamma[3];
+  uint8_t brightness;
+  CRGB balance;
+};
+
+static const Setting settings[] = {
+  {{1.0, 1.0, 1.0}, 255, CRGB(255, 255, 255)},
+  {{2.2, 2.2, 2.2}, 255, CRGB(255, 255, 255)},
+  {{1.0, 1.0, 1.0}, 128, CRGB(255, 255, 255)},
+  {{1.0, 1.0, 1.0}, 255, CRGB(255, 176, 240)},
+  {{2.8, 2.5, 2.2}, 200, CRGB(255, 176, 240)},
+  {{1.8, 1.8, 1.8}, 17, CRGB(90, 255, 3)},
+  {{2.2, 2.2, 2.2}, 0, CRGB(255, 255, 255)},
+};
+
+static void configure(NeoPixelEffectsCorrection &correction, const Setting &setting)
+{
+  correction.setGamma(setting.gamma[0], setting.gamma[1], setting.gamma[2]);
+  correction.setBrightness(setting.brightness);
+  correction.setWhiteBalance(setting.balance);
+}
+
+// The exact corrected value of v on channel c, from 0 to 255
+static double reference(const Setting &setting, int v, int c)
+{
+  return 255.0 * pow(v / 255.0, (double)setting.gamma[c]) * (setting.brightness / 255.0) * (setting.balance.raw[c] / 255.0);
+}
+
+static void checkIdentity()
+{
+  NeoPixelEffectsCorrection correction;
+  fillRamp();
+  correction.apply(ramp, out, 256);
+  for (int v = 0; v < 256; v++) {
+    CHECK_MSG(out[v] == ramp[v], "default correction changed %d", v);
+  }
+
+  correction.setGamma(1.0);
+  correction.setBrightness(255);
+  correction.setWhiteBalance(CRGB(255, 255, 255));
+#if NEOPIXELEFFECTS_DITHER
+  // The tables hold whole values, so no threshold rounds them up
+  correction.setDither(true);
+#endif
+  for (int frame = 0; frame < 8; frame++) {
+    correction.apply(ramp, out, 256);
+    for (int v = 0; v < 256; v++) {
+      CHECK_MSG(out[v] == ramp[v], "frame %d: identity changed %d", frame, v);
+      CHECK(correction.correct(v, v % 3) == v);
+    }
+  }
+}
+
+// Each channel is the reference rounded to the nearest value. The table
+// keeps the value in 1/256 and rounds again, so a reference within a
+// hair of a half may go either way.
+static void checkReference()
+{
+  fillRamp();
+  for (unsigned int s = 0; s < sizeof(settings) / sizeof(settings[0]); s++) {
+    NeoPixelEffectsCorrection correction;
+    configure(correction, settings[s]);
+    correction.apply(ramp, out, 256);
+    for (int v = 0; v < 256; v++) {
+      for (int c = 0; c < 3; c++) {
+        double want = reference(settings[s], v, c);
+        int got = out[v].raw[c];
+        bool halfway = fabs(want - floor(want) - 0.5) < 0.01;
+        bool ok = halfway ? (got == (int)floor(want) || got == (int)ceil(want)) : got == (int)floor(want + 0.5);
+        CHECK_MSG(ok, "setting %d: %d on channel %d gave %d, expected %.3f", s, v, c, got, want);
+        CHECK_MSG(correction.correct(v, c) == got, "setting %d: correct(%d, %d) differs from apply()", s, v, c);
+      }
+    }
+  }
+}
+
+// A limited channel is rounded down: at most the value the table holds
+// scaled by the limit, and no more than one step under the exact value.
+// A limit of 255 means none, and rounds as the unlimited table does.
+static void checkLimit()
+{
+  static const uint8_t limits[] = {0, 1, 64, 127, 128, 200, 254, 255};
+  fillRamp();
+  for (unsigned int s = 0; s < sizeof(settings) / sizeof(settings[0]); s++) {
+    NeoPixelEffectsCorrection correction;
+    configure(correction, settings[s]);
+    CRGB full[256];
+    correction.apply(ramp, full, 256);
+    for (unsigned int l = 0; l < sizeof(limits) / sizeof(limits[0]); l++) {
+      correction.setLimit(limits[l]);
+      CHECK(correction.getLimit() == limits[l]);
+      correction.apply(ramp, out, 256);
+      double scale = (limits[l] + 1) / 256.0;
+      for (int v = 0; v < 256; v++) {
+        for (int c = 0; c < 3; c++) {
+          int got = out[v].raw[c];
+          double limited = reference(settings[s], v, c) * scale;
+#if NEOPIXELEFFECTS_DITHER
+          // The table holds the value to 1/256
+          double most = limited + 1.0 / 256 + 1e-6;
+#else
+          double most = full[v].raw[c] * scale;
+#endif
+          if (limits[l] == 255) {
+            CHECK(got == full[v].raw[c]);
+            continue;
+          }
+          CHECK_MSG(got <= most, "setting %d, limit %d: %d on channel %d gave %d, over %.3f",
+            s, limits[l], v, c, got, most);
+          CHECK_MSG(got >= floor(limited) - 1, "setting %d, limit %d: %d on channel %d gave %d, under %.3f",
+            s, limits[l], v, c, got, limited);
+          CHECK(got <= full[v].raw[c]);
+        }
+      }
+    }
+  }
+}
+
+#if NEOPIXELEFFECTS_DITHER
+// Every pixel sees each of the 256 thresholds once in 256 frames, so the
+// sum of its outputs is the table value in 1/256: the reference to within
+// the table's own rounding
+static void checkDither()
+{
+  fillRamp();
+  for (unsigned int s = 0; s < sizeof(settings) / sizeof(settings[0]); s++) {
+    NeoPixelEffectsCorrection correction;
+    configure(correction, settings[s]);
+    correction.setDither(true);
+    static unsigned long sums[256][3];
+    memset(sums, 0, sizeof(sums));
+    for (int frame = 0; frame < 256; frame++) {
+      correction.apply(ramp, out, 256);
+      for (int v = 0; v < 256; v++) {
+        for (int c = 0; c < 3; c++) {
+          int got = out[v].raw[c];
+          double want = reference(settings[s], v, c);
+          // Each frame rounds to one of the two values either side
+          CHECK_MSG(got >= floor(want) - 1 && got <= ceil(want) + 1, "setting %d frame %d: %d on channel %d gave %d, expected about %.3f",
+            s, frame, v, c, got, want);
+          sums[v][c] += got;
+        }
+      }
+    }
+    for (int v = 0; v < 256; v++) {
+      for (int c = 0; c < 3; c++) {
+        double want = reference(settings[s], v, c) * 256;
+        CHECK_MSG(fabs(sums[v][c] - want) <= 1.0, "setting %d: %d on channel %d averaged %.3f, expected %.3f",
+          s, v, c, sums[v][c] / 256.0, want / 256);
+      }
+    }
+  }
+}
+#endif
+
+int main()
+{
+  checkIdentity();
+  checkReference();
+  checkLimit();
+#if NEOPIXELEFFECTS_DITHER
+  checkDither();
+#endif
+  return testResult();
+}
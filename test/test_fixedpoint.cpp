@@ -0,0 +1,146 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Compares the integer and the floating point render paths. The program
+// is built twice: with NEOPIXELEFFECTS_FIXED_POINT set to 0 it writes the
+// frames of every effect and a set of gradients to the file named on the
+// command line, and with the default setting it draws the same frames and
+// checks that no channel differs by more than 1. Ranges go up to 10,000
+// pixels.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsParticles.h>
+
+#define MAX_LEDS  10000
+#define FRAMES    34
+
+static CRGB leds[MAX_LEDS];
+static CRGB expected[MAX_LEDS];
+static FILE *file;
+static const char *what;
+
+static const int sizes[] = {16, 100, 300, 699, 700, 1000, 2000, 5000, 10000};
+static const int num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+
+// Frames after which the pixels are compared
+static bool sampled(int frame)
+{
+  return frame == 1 || frame == 2 || frame == 3 || frame == 5 || frame == 8 ||
+         frame == 13 || frame == 21 || frame == 34;
+}
+
+// Writes the pixels, or reads the float path's pixels and compares
+static void compare(int numpix, int frame)
+{
+#if !NEOPIXELEFFECTS_FIXED_POINT
+  (void)frame;
+  fwrite(leds, sizeof(CRGB), numpix, file);
+#else
+  size_t got = fread(expected, sizeof(CRGB), numpix, file);
+  CHECK_MSG(got == (size_t)numpix, "%s, %d pixels: float frames end early", what, numpix);
+  int worst = 0;
+  int worst_pixel = 0;
+  for (int i = 0; i < numpix; i++) {
+    for (int c = 0; c < 3; c++) {
+      int diff = abs((int)leds[i][c] - (int)expected[i][c]);
+      if (diff > worst) {
+        worst = diff;
+        worst_pixel = i;
+      }
+    }
+  }
+  CHECK_MSG(worst <= 1, "%s, %d pixels, frame %d: pixel %d is (%d, %d, %d), float path (%d, %d, %d)",
+    what, numpix, frame, worst_pixel, leds[worst_pixel].r, leds[worst_pixel].g, leds[worst_pixel].b,
+    expected[worst_pixel].r, expected[worst_pixel].g, expected[worst_pixel].b);
+#endif
+}
+
+static const char *effect_names[NUM_EFFECT] = {
+  "NONE", "COMET", "LARSON", "CHASE", "PULSE", "STATIC", "FADE", "FILLIN",
+  "GLOW", "RAINBOWWAVE", "STROBE", "SINEWAVE", "RANDOM", "TALKING", "TRIWAVE",
+  "FIREWORK", "SPARKLEFILL"
+};
+
+static void runEffect(Effect effect, int numpix)
+{
+  what = effect_names[effect];
+  fill_solid(leds, numpix, CRGB(250, 180, 90));
+  NeoPixelEffectsParticles particles;
+  NeoPixelEffects fx(leds, effect, 0, numpix - 1, max(numpix / 8, 1), 10, CRGB(200, 150, 77), true, FORWARD);
+#if NEOPIXELEFFECTS_PARTICLES
+  fx.setParticles(&particles);
+#else
+  (void)particles;
+#endif
+
+  unsigned long now = 0;
+  for (int frame = 1; frame <= FRAMES; frame++) {
+    fx.update(now);
+    now += 10;
+    if (sampled(frame)) {
+      compare(numpix, frame);
+    }
+  }
+}
+
+static void runGradient(CRGB from, CRGB to, int numpix)
+{
+  what = "fill_gradient";
+  NeoPixelEffects fx(leds, NONE, 0, numpix - 1, 1, 10, CRGB::Black, true, FORWARD);
+  fx.fill_gradient(from, to);
+  compare(numpix, 0);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s frames.bin\n", argv[0]);
+    return 2;
+  }
+  file = fopen(argv[1], NEOPIXELEFFECTS_FIXED_POINT ? "rb" : "wb");
+  if (file == NULL) {
+    perror(argv[1]);
+    return 2;
+  }
+
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    for (int s = 0; s < num_sizes; s++) {
+      runEffect((Effect)e, sizes[s]);
+    }
+  }
+
+  static const CRGB ends[][2] = {
+    {CRGB::White, CRGB::Black},
+    {CRGB::Black, CRGB::White},
+    {CRGB::Red, CRGB::Blue},
+    {CRGB(10, 200, 30), CRGB(250, 5, 128)},
+  };
+  for (unsigned int g = 0; g < sizeof(ends) / sizeof(ends[0]); g++) {
+    for (int numpix = 1; numpix <= 20; numpix++) {
+      runGradient(ends[g][0], ends[g][1], numpix);
+    }
+    for (int s = 0; s < num_sizes; s++) {
+      runGradient(ends[g][0], ends[g][1], sizes[s]);
+    }
+  }
+
+  fclose(file);
+#if NEOPIXELEFFECTS_FIXED_POINT
+  return testResult();
+#else
+  return 0;
+#endif
+}
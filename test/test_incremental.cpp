@@ -0,0 +1,86 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Runs CHASE and RAINBOWWAVE with scrolling on next to the same effect
+// redrawing every frame, and checks both hold the same pixels after every
+// call. Covers both directions, odd and even ranges and starts, late calls
+// under both timing policies, and the sketch changing the colour, the
+// range or the pixels in between.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+
+#define NUM_LEDS 300
+
+static CRGB scrolled[NUM_LEDS];
+static CRGB redrawn[NUM_LEDS];
+
+static void compare(Effect effect, int start, int end, bool dir, TimingPolicy policy, int frames, int step)
+{
+  fill_solid(scrolled, NUM_LEDS, CRGB::Black);
+  fill_solid(redrawn, NUM_LEDS, CRGB::Black);
+  NeoPixelEffects a(scrolled, effect, start, end, 3, 10, CRGB(250, 40, 7), true, dir);
+  NeoPixelEffects b(redrawn, effect, start, end, 3, 10, CRGB(250, 40, 7), true, dir);
+  a.setIncremental(true);
+  a.setTimingPolicy(policy);
+  b.setTimingPolicy(policy);
+  CHECK(a.getIncremental() && !b.getIncremental());
+
+  unsigned long now = 1000;
+  for (int frame = 0; frame < frames; frame++) {
+    // Mostly on time, sometimes several ticks late
+    now += (frame % 23 == 7) ? 10 * step + 7 : step;
+    if (frame == frames / 4) {
+      a.setColor(CRGB::Green);
+      b.setColor(CRGB::Green);
+    } else if (frame == frames / 2) {
+      a.setBackgroundColor(CRGB(1, 2, 3));
+      b.setBackgroundColor(CRGB(1, 2, 3));
+    } else if (frame == frames / 2 + 5) {
+      a.setRange(start + 1, end);
+      b.setRange(start + 1, end);
+    } else if (frame == 3 * frames / 4) {
+      a.fill_solid(CRGB::Blue);
+      b.fill_solid(CRGB::Blue);
+    } else if (frame == 3 * frames / 4 + 9) {
+      a.render(17);
+      b.render(17);
+    }
+    bool ra = a.update(now);
+    bool rb = b.update(now);
+    CHECK_MSG(ra == rb, "effect %d, %d-%d, dir %d, policy %d, frame %d: rendered differs", effect, start, end, dir, policy, frame);
+    CHECK_MSG(memcmp(scrolled, redrawn, sizeof(scrolled)) == 0, "effect %d, %d-%d, dir %d, policy %d, frame %d: pixels differ",
+              effect, start, end, dir, policy, frame);
+  }
+}
+
+int main()
+{
+  static const int ranges[][2] = {{0, 0}, {0, 1}, {3, 4}, {0, 59}, {7, 66}, {1, 298}, {10, 10 + 255}};
+  static const Effect effects[] = {CHASE, RAINBOWWAVE};
+  for (int e = 0; e < 2; e++) {
+    for (unsigned int r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+      for (int dir = 0; dir < 2; dir++) {
+        compare(effects[e], ranges[r][0], ranges[r][1], dir ? FORWARD : REVERSE, TIMING_SKIP, 400, 10);
+        compare(effects[e], ranges[r][0], ranges[r][1], dir ? FORWARD : REVERSE, TIMING_CATCHUP, 400, 10);
+      }
+    }
+  }
+
+  // Long enough for the rainbow counter to wrap in compact builds
+  compare(RAINBOWWAVE, 0, 15, FORWARD, TIMING_SKIP, 70000, 10);
+  compare(RAINBOWWAVE, 0, 15, REVERSE, TIMING_SKIP, 70000, 10);
+  return testResult();
+}
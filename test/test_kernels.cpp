@@ -0,0 +1,147 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Compares fillPixels(), scalePixels(), sumPixels() and shiftPixels()
+// with plain per-byte loops, for every length up to a few vectors and
+// some long ones, starting at every byte offset within a vector, and
+// checks that no byte outside the pixels is touched. Built once with the
+// SIMD kernels the host supports and once with NEOPIXELEFFECTS_NO_SIMD.
+
+#include "test.h"
+#include <NeoPixelEffectsKernels.h>
+
+#define GUARD     32
+#define MAX_LEDS  1100
+#define OFFSETS   32
+
+static uint8_t buffer[GUARD + OFFSETS + MAX_LEDS * 3 + GUARD];
+static uint8_t expected[sizeof(buffer)];
+
+static const char *simdName()
+{
+#if defined(NEOPIXELEFFECTS_SIMD_AVX2)
+  return "AVX2";
+#elif defined(NEOPIXELEFFECTS_SIMD_SSE2)
+  return "SSE2";
+#elif defined(NEOPIXELEFFECTS_SIMD_NEON)
+  return "NEON";
+#else
+  return "portable";
+#endif
+}
+
+static uint32_t seed = 12345;
+
+static uint8_t nextByte()
+{
+  seed = seed * 1103515245 + 12345;
+  return seed >> 16;
+}
+
+static void randomize()
+{
+  for (size_t i = 0; i < sizeof(buffer); i++) {
+    buffer[i] = nextByte();
+  }
+  memcpy(expected, buffer, sizeof(buffer));
+}
+
+static bool unchanged()
+{
+  return memcmp(buffer, expected, sizeof(buffer)) == 0;
+}
+
+static void checkLength(int count, int offset)
+{
+  int start = GUARD + offset;
+  CRGB *pix = (CRGB *)(buffer + start);
+  long bytes = (long)count * 3;
+
+  randomize();
+  CRGB color(nextByte(), nextByte(), nextByte());
+  fillPixels(pix, count, color);
+  for (long i = 0; i < bytes; i += 3) {
+    expected[start + i] = color.r;
+    expected[start + i + 1] = color.g;
+    expected[start + i + 2] = color.b;
+  }
+  CHECK_MSG(unchanged(), "fillPixels, %d pixels at offset %d", count, offset);
+
+  static const uint16_t fractions[] = {0, 1, 255, 256, 0x8000, 0xFFFF, 43254};
+  for (unsigned int f = 0; f < sizeof(fractions) / sizeof(fractions[0]); f++) {
+    randomize();
+    uint32_t sum = scalePixels(pix, count, fractions[f]);
+    uint32_t expectedsum = 0;
+    for (long i = 0; i < bytes; i++) {
+      expected[start + i] = ((uint32_t)expected[start + i] * fractions[f]) >> 16;
+      expectedsum += expected[start + i];
+    }
+    CHECK_MSG(unchanged(), "scalePixels by %u, %d pixels at offset %d", fractions[f], count, offset);
+    CHECK_MSG(sum == expectedsum, "scalePixels by %u, %d pixels at offset %d: sum %lu, expected %lu",
+      fractions[f], count, offset, (unsigned long)sum, (unsigned long)expectedsum);
+  }
+
+  randomize();
+  uint32_t expectedsum = 0;
+  for (long i = 0; i < bytes; i++) {
+    expectedsum += buffer[start + i];
+  }
+  uint32_t sum = sumPixels(pix, count);
+  CHECK_MSG(sum == expectedsum, "sumPixels, %d pixels at offset %d: %lu, expected %lu",
+    count, offset, (unsigned long)sum, (unsigned long)expectedsum);
+  CHECK(unchanged());
+
+  for (int towardstart = 0; towardstart <= 1; towardstart++) {
+    randomize();
+    shiftPixels(pix, count, towardstart);
+    if (count > 1) {
+      if (towardstart) {
+        for (long i = 0; i < bytes - 3; i++) {
+          expected[start + i] = expected[start + i + 3];
+        }
+      } else {
+        for (long i = bytes - 1; i >= 3; i--) {
+          expected[start + i] = expected[start + i - 3];
+        }
+      }
+    }
+    CHECK_MSG(unchanged(), "shiftPixels %s, %d pixels at offset %d", towardstart ? "towards start" : "towards end", count, offset);
+  }
+}
+
+// Full channels summed over a long strip
+static void checkSaturated()
+{
+  CRGB *pix = (CRGB *)(buffer + GUARD + 1);
+  fillPixels(pix, MAX_LEDS, CRGB(255, 255, 255));
+  CHECK(sumPixels(pix, MAX_LEDS) == (uint32_t)MAX_LEDS * 765);
+  CHECK(scalePixels(pix, MAX_LEDS, 0xFFFF) == (uint32_t)MAX_LEDS * 3 * 254);
+  CHECK(pix[MAX_LEDS - 1] == CRGB(254, 254, 254));
+}
+
+int main()
+{
+  printf("%s kernels\n", simdName());
+  for (int offset = 0; offset < OFFSETS; offset++) {
+    for (int count = 0; count <= 100; count++) {
+      checkLength(count, offset);
+    }
+    checkLength(255, offset);
+    checkLength(1024, offset);
+    checkLength(MAX_LEDS - 1, offset);
+  }
+  checkSaturated();
+  return testResult();
+}
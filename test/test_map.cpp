@@ -0,0 +1,246 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks NeoPixelEffectsMap: serpentine() tables in both orientations
+// against a walk along the wiring, apply() with the span clipped at either
+// end and with holes in the table, matrixPhases() for every pattern
+// against the formulas in double precision, and, with the cache compiled
+// in, RAINBOWWAVE drawing from kept phases against hues worked out here.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsMap.h>
+#include <math.h>
+
+#define MAX_LEDS  400
+#define DELAY     10
+
+static uint16_t table[MAX_LEDS];
+static CRGB logical[MAX_LEDS];
+static CRGB leds[MAX_LEDS];
+static uint8_t phases[MAX_LEDS + 1];
+static const CRGB guard(1, 2, 3);
+
+// Follows the wire from its first LED: each row (or column) runs the
+// opposite way to the one before
+static void checkSerpentine(int width, int height, bool vertical)
+{
+  NeoPixelEffectsMap::serpentine(table, width, height, vertical);
+  int length = vertical ? height : width;
+  for (int wire = 0; wire < width * height; wire++) {
+    int line = wire / length;
+    int along = (line % 2 == 0) ? wire % length : length - 1 - wire % length;
+    int x = vertical ? line : along;
+    int y = vertical ? along : line;
+    CHECK_MSG(table[y * width + x] == wire, "%dx%d%s: (%d, %d) maps to %d, wired as %d",
+      width, height, vertical ? " vertical" : "", x, y, table[y * width + x], wire);
+  }
+}
+
+static void fillLogical(int count)
+{
+  for (int i = 0; i < count; i++) {
+    logical[i] = CRGB(i, 255 - i, i * 3);
+  }
+}
+
+// Checks every LED against the logical pixel mapped to it if that pixel
+// is within first to last, and against the guard otherwise
+static void checkApplied(NeoPixelEffectsMap &map, int numleds, int first, int last)
+{
+  int count = map.getCount();
+  for (int led = 0; led < numleds; led++) {
+    CRGB want = guard;
+    for (int i = max(first, 0); i <= min(last, count - 1); i++) {
+      if (map.getIndex(i) == led) {
+        want = logical[i];
+      }
+    }
+    CHECK_MSG(leds[led] == want, "apply(%d, %d): LED %d", first, last, led);
+  }
+}
+
+static void checkApply()
+{
+  const int width = 7;
+  const int height = 5;
+  const int count = width * height;
+  // A matrix with its corners cut off, so those LEDs are not fitted and
+  // the wire is shorter than the logical buffer
+  NeoPixelEffectsMap::serpentine(table, width, height);
+  static const int corners[] = {0, width - 1, count - width, count - 1};
+  int numleds = 0;
+  for (int i = 0; i < count; i++) {
+    bool corner = false;
+    for (int c = 0; c < 4; c++) {
+      corner |= (i == corners[c]);
+    }
+    table[i] = corner ? NEOPIXELEFFECTS_NO_PIXEL : table[i];
+  }
+  // Close the gaps the corners leave in the wiring
+  for (int wire = 0, led = 0; wire < count; wire++) {
+    for (int i = 0; i < count; i++) {
+      if (table[i] == wire) {
+        table[i] = led++;
+        numleds = led;
+      }
+    }
+  }
+
+  NeoPixelEffectsMap map(table, count);
+  CHECK(map.getCount() == count);
+  CHECK(map.getIndex(-1) == NEOPIXELEFFECTS_NO_PIXEL);
+  CHECK(map.getIndex(count) == NEOPIXELEFFECTS_NO_PIXEL);
+  CHECK(map.getIndex(0) == NEOPIXELEFFECTS_NO_PIXEL);
+  fillLogical(count);
+
+  static const int spans[][2] = {
+    {0, count - 1}, {-5, 3}, {-100, -1}, {count - 4, count + 20}, {count, count + 5},
+    {10, 20}, {12, 12}, {20, 10}, {-3, count + 3}, {1, 1},
+  };
+  for (unsigned int s = 0; s < sizeof(spans) / sizeof(spans[0]); s++) {
+    fill_solid(leds, MAX_LEDS, guard);
+    map.apply(logical, leds, spans[s][0], spans[s][1]);
+    checkApplied(map, MAX_LEDS, spans[s][0], spans[s][1]);
+  }
+
+  fill_solid(leds, MAX_LEDS, guard);
+  map.apply(logical, leds);
+  checkApplied(map, MAX_LEDS, 0, count - 1);
+  CHECK(numleds == count - 4);
+  for (int led = 0; led < numleds; led++) {
+    CHECK_MSG(leds[led] != guard, "LED %d not written", led);
+  }
+}
+
+static long referencePhase(int x, int y, int width, int height, PhasePattern pattern)
+{
+  int cx = width - 1;
+  int cy = height - 1;
+  double furthest = sqrt((double)cx * cx + (double)cy * cy);
+  if (furthest == 0) {
+    furthest = 1;
+  }
+  double dx = 2 * x - cx;
+  double dy = 2 * y - cy;
+  switch (pattern) {
+    case PHASE_HORIZONTAL:
+      return 255L * x / width;
+    case PHASE_VERTICAL:
+      return 255L * y / height;
+    case PHASE_DIAGONAL:
+      return 255L * (x + y) / (width + height - 1);
+    case PHASE_RADIAL:
+      return (long)floor(255 * sqrt(dx * dx + dy * dy) / furthest);
+    default:
+      return (long)floor((atan2(dy, dx) + M_PI) * 256 / (2 * M_PI)) & 0xFF;
+  }
+}
+
+static void checkPhases(int width, int height)
+{
+  for (int p = 0; p < NUM_PHASEPATTERN; p++) {
+    PhasePattern pattern = (PhasePattern)p;
+    memset(phases, 0xAA, sizeof(phases));
+    NeoPixelEffectsMap::matrixPhases(phases, width, height, pattern);
+    // Radial and angular phases are worked out in float; allow the last
+    // bit of rounding either way
+    int slack = (pattern == PHASE_RADIAL || pattern == PHASE_ANGULAR) ? 1 : 0;
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        int got = phases[y * width + x];
+        int want = referencePhase(x, y, width, height, pattern);
+        int diff = abs(got - want);
+        // Angles wrap around
+        diff = min(diff, 256 - diff);
+        CHECK_MSG(diff <= slack, "%dx%d pattern %d: (%d, %d) phase %d, expected %d", width, height, p, x, y, got, want);
+      }
+    }
+    CHECK_MSG(phases[width * height] == 0xAA, "%dx%d pattern %d: wrote past the matrix", width, height, p);
+  }
+
+  // Shapes the patterns promise: rings are the same at all four corners,
+  // and opposite sides of the centre are half a turn apart
+  NeoPixelEffectsMap::matrixPhases(phases, width, height, PHASE_RADIAL);
+  int last = width * height - 1;
+  CHECK(phases[0] == phases[width - 1] && phases[0] == phases[last - width + 1] && phases[0] == phases[last]);
+  if (width > 1 || height > 1) {
+    CHECK_MSG(phases[0] >= 254, "%dx%d: corner at radius %d", width, height, phases[0]);
+  }
+  if (width >= 2 && height >= 2) {
+    NeoPixelEffectsMap::matrixPhases(phases, width, height, PHASE_ANGULAR);
+    int diff = (uint8_t)(phases[last] - phases[0]);
+    CHECK_MSG(diff >= 127 && diff <= 129, "%dx%d: opposite corners %d and %d", width, height, phases[0], phases[last]);
+  }
+}
+
+#if NEOPIXELEFFECTS_CACHE
+// Each pixel shows the hue of its own phase plus the frame's offset
+static void checkKeptPhases(bool direction, bool incremental)
+{
+  const int width = 12;
+  const int height = 9;
+  const int count = width * height;
+  const int start = 7;
+  NeoPixelEffectsMap::matrixPhases(phases, width, height, PHASE_RADIAL);
+  uint8_t kept[count];
+  memcpy(kept, phases, count);
+
+  NeoPixelEffectsCache cache(phases, count);
+  cache.keepphases = true;
+  fill_solid(leds, MAX_LEDS, guard);
+  NeoPixelEffects fx(leds, RAINBOWWAVE, start, start + count - 1, 1, DELAY, CRGB::White, true, direction);
+  fx.setCache(&cache);
+  fx.setIncremental(incremental);
+
+  long counter = (direction == FORWARD) ? 0 : 100;
+  unsigned long now = 1000;
+  for (int frame = 0; frame < 150; frame++) {
+    fx.update(now);
+    now += DELAY;
+    // floor(counter * 255 / count), also for the negative counters of a
+    // reversed rainbow
+    long offset = (long)floor(counter * 255.0 / count);
+    for (int i = 0; i < count; i++) {
+      CRGB want = CHSV((uint8_t)(kept[i] + offset), 255, 255);
+      CHECK_MSG(leds[start + i] == want, "%s%s frame %d: pixel %d", direction == FORWARD ? "forward" : "reverse",
+        incremental ? " incremental" : "", frame, i);
+    }
+    counter += (direction == FORWARD) ? 1 : -1;
+  }
+  CHECK_MSG(memcmp(phases, kept, count) == 0, "%s", "kept phases rebuilt");
+  for (int i = 0; i < start; i++) {
+    CHECK(leds[i] == guard);
+  }
+  CHECK(leds[start + count] == guard);
+}
+#endif
+
+int main()
+{
+  static const int sizes[][2] = {{1, 1}, {1, 6}, {6, 1}, {4, 4}, {5, 3}, {8, 7}, {16, 16}, {20, 20}};
+  for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    checkSerpentine(sizes[s][0], sizes[s][1], false);
+    checkSerpentine(sizes[s][0], sizes[s][1], true);
+    checkPhases(sizes[s][0], sizes[s][1]);
+  }
+  checkApply();
+#if NEOPIXELEFFECTS_CACHE
+  checkKeptPhases(FORWARD, false);
+  checkKeptPhases(REVERSE, false);
+  checkKeptPhases(FORWARD, true);
+#endif
+  return testResult();
+}
@@ -0,0 +1,287 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Runs NeoPixelEffectsOutput against a sink that keeps every frame in
+// memory and can be held mid-write, so a slow device is simulated without
+// any timing: frames are checked as written, frames submitted while the
+// sink is busy are replaced or refused and counted, a correction is
+// applied on the way out, and the destructor writes what is still queued
+// before it returns.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsCorrection.h>
+#include <NeoPixelEffectsOutput.h>
+#include <vector>
+
+#define NUM_LEDS 37
+
+class MemorySink : public NeoPixelEffectsSink {
+  public:
+    MemorySink() : _held(false), _writing(false), _fail(false) {}
+
+    bool write(const CRGB *pixels, int numpix)
+    {
+      std::unique_lock<std::mutex> guard(_lock);
+      _writing = true;
+      _changed.notify_all();
+      _changed.wait(guard, [this] { return !_held; });
+      frames.push_back(std::vector<CRGB>(pixels, pixels + numpix));
+      _writing = false;
+      return !_fail;
+    }
+
+    // Writes started after hold() wait until release()
+    void hold()
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _held = true;
+    }
+
+    void release()
+    {
+      {
+        std::lock_guard<std::mutex> guard(_lock);
+        _held = false;
+      }
+      _changed.notify_all();
+    }
+
+    // Returns once the output thread is inside write()
+    void waitForWrite()
+    {
+      std::unique_lock<std::mutex> guard(_lock);
+      _changed.wait(guard, [this] { return _writing; });
+    }
+
+    void setFail(bool fail)
+    {
+      std::lock_guard<std::mutex> guard(_lock);
+      _fail = fail;
+    }
+
+    std::vector<std::vector<CRGB> > frames;
+
+  private:
+    std::mutex _lock;
+    std::condition_variable _changed;
+    bool _held;
+    bool _writing;
+    bool _fail;
+};
+
+static CRGB leds[NUM_LEDS];
+
+// A frame that differs from every other value of n in each pixel
+static void drawFrame(int n)
+{
+  for (int i = 0; i < NUM_LEDS; i++) {
+    leds[i] = CRGB(n, i, (n * 7 + i) & 0xFF);
+  }
+}
+
+static bool sameFrame(const std::vector<CRGB> &frame, const CRGB *pixels)
+{
+  if (frame.size() != NUM_LEDS) {
+    return false;
+  }
+  for (int i = 0; i < NUM_LEDS; i++) {
+    if (frame[i] != pixels[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void checkFrames()
+{
+  MemorySink sink;
+  NeoPixelEffectsOutput output(leds, NUM_LEDS, sink);
+  CRGB expected[5][NUM_LEDS];
+  for (int n = 0; n < 5; n++) {
+    drawFrame(n + 1);
+    memcpy(expected[n], leds, sizeof(leds));
+    CHECK(output.submit());
+    output.flush();
+  }
+  CHECK_MSG(output.getFrames() == 5, "%lu frames written", output.getFrames());
+  CHECK(output.getDroppedFrames() == 0);
+  CHECK(output.getWriteErrors() == 0);
+  CHECK_MSG(sink.frames.size() == 5, "sink got %d frames", (int)sink.frames.size());
+  for (size_t n = 0; n < sink.frames.size() && n < 5; n++) {
+    CHECK_MSG(sameFrame(sink.frames[n], expected[n]), "frame %d", (int)n);
+  }
+  CHECK(output.getMaxLatency() >= output.getLatency());
+
+  output.resetStats();
+  CHECK(output.getFrames() == 0);
+  CHECK(output.getMaxLatency() == 0);
+  CHECK(output.getAverageLatency() == 0);
+}
+
+// With three buffers each frame submitted while one is on the wire
+// replaces the one waiting, so only the newest is written next
+static void checkReplaced()
+{
+  MemorySink sink;
+  NeoPixelEffectsOutput output(leds, NUM_LEDS, sink, 3);
+  CRGB first[NUM_LEDS];
+  CRGB last[NUM_LEDS];
+
+  sink.hold();
+  drawFrame(1);
+  memcpy(first, leds, sizeof(leds));
+  CHECK(output.submit());
+  sink.waitForWrite();
+  for (int n = 2; n <= 6; n++) {
+    drawFrame(n);
+    CHECK_MSG(output.submit(), "frame %d refused", n);
+  }
+  memcpy(last, leds, sizeof(leds));
+  sink.release();
+  output.flush();
+
+  CHECK_MSG(output.getFrames() == 2, "%lu frames written", output.getFrames());
+  CHECK_MSG(output.getDroppedFrames() == 4, "%lu frames dropped", output.getDroppedFrames());
+  CHECK_MSG(sink.frames.size() == 2, "sink got %d frames", (int)sink.frames.size());
+  if (sink.frames.size() == 2) {
+    CHECK(sameFrame(sink.frames[0], first));
+    CHECK(sameFrame(sink.frames[1], last));
+  }
+}
+
+// With two buffers a frame submitted while both are busy is refused, and
+// the one already waiting is still written
+static void checkRefused()
+{
+  MemorySink sink;
+  NeoPixelEffectsOutput output(leds, NUM_LEDS, sink, 2);
+  CRGB waiting[NUM_LEDS];
+
+  sink.hold();
+  drawFrame(1);
+  CHECK(output.submit());
+  sink.waitForWrite();
+  drawFrame(2);
+  memcpy(waiting, leds, sizeof(leds));
+  CHECK(output.submit());
+  for (int n = 3; n <= 5; n++) {
+    drawFrame(n);
+    CHECK_MSG(!output.submit(), "frame %d accepted with both buffers busy", n);
+  }
+  sink.release();
+  output.flush();
+
+  CHECK_MSG(output.getFrames() == 2, "%lu frames written", output.getFrames());
+  CHECK_MSG(output.getDroppedFrames() == 3, "%lu frames dropped", output.getDroppedFrames());
+  CHECK_MSG(sink.frames.size() == 2, "sink got %d frames", (int)sink.frames.size());
+  if (sink.frames.size() == 2) {
+    CHECK(sameFrame(sink.frames[1], waiting));
+  }
+}
+
+static void checkErrors()
+{
+  MemorySink sink;
+  NeoPixelEffectsOutput output(leds, NUM_LEDS, sink);
+  sink.setFail(true);
+  for (int n = 0; n < 3; n++) {
+    drawFrame(n);
+    output.submit();
+    output.flush();
+  }
+  sink.setFail(false);
+  output.submit();
+  output.flush();
+  CHECK_MSG(output.getWriteErrors() == 3, "%lu write errors", output.getWriteErrors());
+  CHECK(output.getFrames() == 4);
+}
+
+// The sink gets the frame as the correction would write it, and the
+// pixels the effects draw on are left alone
+static void checkCorrection()
+{
+  MemorySink sink;
+  NeoPixelEffectsOutput output(leds, NUM_LEDS, sink);
+  NeoPixelEffectsCorrection correction;
+  correction.setGamma(2.2);
+  correction.setBrightness(150);
+  correction.setWhiteBalance(CRGB(255, 200, 160));
+#if NEOPIXELEFFECTS_DITHER
+  // Dithering carries state from one frame to the next
+  correction.setDither(false);
+#endif
+  output.setCorrection(&correction);
+
+  drawFrame(200);
+  CRGB drawn[NUM_LEDS];
+  CRGB corrected[NUM_LEDS];
+  memcpy(drawn, leds, sizeof(leds));
+  correction.apply(leds, corrected, NUM_LEDS);
+  CHECK(output.submit());
+  output.flush();
+  CHECK(memcmp(leds, drawn, sizeof(leds)) == 0);
+  CHECK(sink.frames.size() == 1);
+  if (sink.frames.size() == 1) {
+    CHECK(sameFrame(sink.frames[0], corrected));
+  }
+
+  output.setCorrection(NULL);
+  CHECK(output.submit());
+  output.flush();
+  CHECK(sink.frames.size() == 2);
+  if (sink.frames.size() == 2) {
+    CHECK(sameFrame(sink.frames[1], drawn));
+  }
+}
+
+// Destroying the output writes the frame still queued, then stops the
+// thread, with or without anything left to send
+static void checkShutdown()
+{
+  MemorySink sink;
+  CRGB last[NUM_LEDS];
+  {
+    NeoPixelEffectsOutput output(leds, NUM_LEDS, sink);
+    sink.hold();
+    drawFrame(1);
+    output.submit();
+    sink.waitForWrite();
+    drawFrame(2);
+    memcpy(last, leds, sizeof(leds));
+    output.submit();
+    sink.release();
+  }
+  CHECK_MSG(sink.frames.size() == 2, "sink got %d frames", (int)sink.frames.size());
+  if (sink.frames.size() == 2) {
+    CHECK(sameFrame(sink.frames[1], last));
+  }
+
+  {
+    NeoPixelEffectsOutput idle(leds, NUM_LEDS, sink, 2);
+  }
+  CHECK(sink.frames.size() == 2);
+}
+
+int main()
+{
+  checkFrames();
+  checkReplaced();
+  checkRefused();
+  checkErrors();
+  checkCorrection();
+  checkShutdown();
+  return testResult();
+}
@@ -0,0 +1,62 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Renders more effects than a manager can hold on several threads and
+// checks every frame against updating the same effects one by one.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsParallel.h>
+
+#define NUM_SEGMENTS 300
+#define SEGMENT_LEN  40
+#define NUM_LEDS     (NUM_SEGMENTS * SEGMENT_LEN)
+#define NUM_FRAMES   50
+
+static CRGB serial_leds[NUM_LEDS];
+static CRGB parallel_leds[NUM_LEDS];
+static NeoPixelEffects serial_fx[NUM_SEGMENTS];
+static NeoPixelEffects parallel_fx[NUM_SEGMENTS];
+
+static void setUp(NeoPixelEffects *effects, CRGB *leds)
+{
+  for (int i = 0; i < NUM_SEGMENTS; i++) {
+    Effect effect = (Effect)(COMET + i % (NUM_EFFECT - COMET));
+    effects[i] = NeoPixelEffects(leds, effect, i * SEGMENT_LEN, (i + 1) * SEGMENT_LEN - 1, 4, i % 7,
+                                 CHSV(i * 13, 255, 255), true, (i & 1) ? REVERSE : FORWARD);
+  }
+}
+
+int main()
+{
+  CHECK(NUM_SEGMENTS > NEOPIXELEFFECTS_MAX_MANAGED);
+  setUp(serial_fx, serial_leds);
+  setUp(parallel_fx, parallel_leds);
+
+  for (unsigned int threads = 1; threads <= 4; threads++) {
+    NeoPixelEffectsParallel renderer(parallel_fx, NUM_SEGMENTS, threads);
+    CHECK(renderer.getThreadCount() == threads);
+    for (int frame = 0; frame < NUM_FRAMES; frame++) {
+      unsigned long now = 1000 + (threads - 1) * NUM_FRAMES * 10 + frame * 10;
+      bool changed = false;
+      for (int i = 0; i < NUM_SEGMENTS; i++) {
+        changed |= serial_fx[i].update(now);
+      }
+      CHECK_MSG(renderer.update(now) == changed, "%u threads, frame %d: changed flag differs", threads, frame);
+      CHECK_MSG(memcmp(serial_leds, parallel_leds, sizeof(serial_leds)) == 0, "%u threads, frame %d: pixels differ", threads, frame);
+    }
+  }
+  return testResult();
+}
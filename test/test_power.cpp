@@ -0,0 +1,163 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks the load every effect keeps as it draws against the channels of
+// its range added up pixel by pixel, after every frame, for full redraws
+// and incremental scrolling, the same for the segments of a
+// NeoPixelEffectsPool, and the power limiter's estimate against the same
+// brute-force sum over a whole strip.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsManager.h>
+#include <NeoPixelEffectsParticles.h>
+#include <NeoPixelEffectsPool.h>
+#include <NeoPixelEffectsPower.h>
+
+#define GUARD   3
+#define MAX_LEDS 300
+#define DELAY   10
+#define FRAMES  250
+
+static CRGB leds[MAX_LEDS + 2 * GUARD];
+
+static uint32_t bruteLoad(const CRGB *pix, int count)
+{
+  uint32_t load = 0;
+  for (int i = 0; i < count; i++) {
+    load += pix[i].r + pix[i].g + pix[i].b;
+  }
+  return load;
+}
+
+static void checkEffect(Effect effect, int numpix, int aoe, bool incremental)
+{
+  // Lit guard pixels would show up in a load that strays outside the range
+  fill_solid(leds, numpix + 2 * GUARD, CRGB(9, 8, 7));
+  NeoPixelEffectsParticles particles;
+  NeoPixelEffects fx(leds, effect, GUARD, GUARD + numpix - 1, aoe, DELAY, CRGB(200, 90, 255), true, FORWARD);
+#if NEOPIXELEFFECTS_PARTICLES
+  fx.setParticles(&particles);
+#else
+  (void)particles;
+#endif
+  fx.setIncremental(incremental);
+  // FADE dims what is already there
+  fx.fill_solid(CRGB(250, 40, 120));
+  CHECK_MSG(fx.getLoad() == bruteLoad(leds + GUARD, numpix), "effect %d, %d pixels: fill", effect, numpix);
+
+  unsigned long now = 1000;
+  for (int frame = 0; frame < FRAMES; frame++) {
+    if (fx.getStatus() != ACTIVE) {
+      fx.setEffect(effect);
+    }
+    fx.update(now);
+    now += DELAY;
+    CHECK_MSG(fx.getLoad() == bruteLoad(leds + GUARD, numpix), "effect %d, %d pixels, aoe %d%s: frame %d load %lu, counted %lu",
+      effect, numpix, aoe, incremental ? ", incremental" : "", frame, (unsigned long)fx.getLoad(), (unsigned long)bruteLoad(leds + GUARD, numpix));
+  }
+
+  fx.fill_gradient(CRGB(255, 0, 31), CRGB(3, 200, 90));
+  CHECK_MSG(fx.getLoad() == bruteLoad(leds + GUARD, numpix), "effect %d, %d pixels: gradient", effect, numpix);
+  leds[GUARD] = CRGB::White;
+  fx.measureLoad();
+  CHECK_MSG(fx.getLoad() == bruteLoad(leds + GUARD, numpix), "effect %d, %d pixels: measured", effect, numpix);
+}
+
+// Segments of different lengths with a gap between two of them
+static void checkPool(Effect effect)
+{
+  fill_solid(leds, MAX_LEDS, CRGB::Black);
+  NeoPixelEffectsPool pool(leds, effect, DELAY);
+  pool.add(0, 0, CRGB(255, 255, 255));
+  pool.add(1, 40, CRGB(10, 200, 30), REVERSE);
+  pool.add(50, 52, CRGB(99, 0, 1));
+  pool.add(53, 299, CRGB(180, 77, 250));
+  pool.setBackgroundColor(2, CRGB(5, 6, 7));
+
+  unsigned long now = 1000;
+  for (int frame = 0; frame < FRAMES; frame++) {
+    pool.update(now);
+    now += DELAY;
+    uint32_t counted = bruteLoad(leds, 41) + bruteLoad(leds + 50, 250);
+    CHECK_MSG(pool.getLoad() == counted, "pool effect %d frame %d: load %lu, counted %lu", effect, frame, (unsigned long)pool.getLoad(), (unsigned long)counted);
+    unsigned long current = ((unsigned long)counted * NEOPIXELEFFECTS_CHANNEL_MA + 127) / 255 + 291 * NEOPIXELEFFECTS_IDLE_MA;
+    CHECK_MSG(pool.getCurrent() == current, "pool effect %d frame %d: %lu mA, counted %lu mA", effect, frame, pool.getCurrent(), current);
+  }
+}
+
+// Three segments and a pool with a brightness below full and a budget the
+// strip goes over, so the limiter both estimates and dims. The frame the
+// correction then writes out is counted pixel by pixel and must stay
+// within the budget too.
+static void checkLimiter()
+{
+  static CRGB out[MAX_LEDS];
+  const int numpix = MAX_LEDS;
+  const unsigned long budget = 1500;
+  fill_solid(leds, numpix, CRGB::Black);
+  NeoPixelEffects effects[3];
+  effects[0] = NeoPixelEffects(leds, RAINBOWWAVE, 0, 59, 1, DELAY, CRGB::White, true, FORWARD);
+  effects[1] = NeoPixelEffects(leds, RANDOM, 60, 119, 1, DELAY, CRGB::White, true, FORWARD);
+  effects[2] = NeoPixelEffects(leds, GLOW, 120, 179, 9, DELAY, CRGB(255, 255, 80), true, FORWARD);
+  NeoPixelEffectsManager manager;
+  manager.add(effects, 3);
+  NeoPixelEffectsPool pool(leds, PULSE, DELAY);
+  for (int i = 180; i < numpix; i += 20) {
+    pool.add(i, i + 19, CRGB(i, 255 - i, 200), (i / 20) % 2);
+  }
+  NeoPixelEffectsCorrection correction;
+  correction.setBrightness(200);
+  NeoPixelEffectsPowerLimiter limiter(manager, correction, numpix, budget);
+  CHECK(limiter.addPool(&pool));
+
+  unsigned long now = 1000;
+  bool dimmed = false;
+  for (int frame = 0; frame < FRAMES; frame++) {
+    manager.update(now);
+    pool.update(now);
+    now += DELAY;
+    dimmed |= limiter.update();
+
+    unsigned long lit = ((unsigned long)bruteLoad(leds, numpix) * NEOPIXELEFFECTS_CHANNEL_MA + 127) / 255;
+    lit = (lit * 200 + 127) / 255;
+    unsigned long expected = lit + (unsigned long)numpix * NEOPIXELEFFECTS_IDLE_MA;
+    CHECK_MSG(limiter.getCurrent() == expected, "limiter frame %d: estimate %lu mA, counted %lu mA", frame, limiter.getCurrent(), expected);
+    CHECK_MSG(limiter.getLimitedCurrent() <= budget, "limiter frame %d: %lu mA after dimming", frame, limiter.getLimitedCurrent());
+
+    correction.apply(leds, out, numpix);
+    unsigned long drawn = ((unsigned long)bruteLoad(out, numpix) * NEOPIXELEFFECTS_CHANNEL_MA + 127) / 255 + (unsigned long)numpix * NEOPIXELEFFECTS_IDLE_MA;
+    CHECK_MSG(drawn <= budget, "limiter frame %d: corrected frame draws %lu mA", frame, drawn);
+  }
+  CHECK_MSG(dimmed, "limiter never dimmed");
+}
+
+int main()
+{
+  // TALKING needs six pixels
+  static const int sizes[] = {6, 7, 17, 60, MAX_LEDS};
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      int numpix = sizes[s];
+      checkEffect((Effect)e, numpix, 1, false);
+      checkEffect((Effect)e, numpix, max(numpix / 6, 1), false);
+      checkEffect((Effect)e, numpix, max(numpix / 6, 1), true);
+    }
+  }
+  checkPool(PULSE);
+  checkPool(STROBE);
+  checkLimiter();
+  return testResult();
+}
@@ -0,0 +1,207 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Records every effect at several strip sizes and plays the recording
+// back, checking each decoded frame against the one recorded. Also checks
+// seek() to keyframes and to the frames between them, playback with
+// setRepeat(), and that begin() turns down a truncated or damaged
+// recording and one made for a different pixel count.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsParticles.h>
+#include <NeoPixelEffectsRecording.h>
+#include <vector>
+
+#define MAX_LEDS  1000
+#define DELAY     10
+#define FRAMES    120
+
+typedef std::vector<CRGB> Frame;
+
+static CRGB leds[MAX_LEDS];
+static CRGB played[MAX_LEDS];
+
+// Renders an effect for a number of frames, recording each one, and
+// returns the recording. The frames drawn are kept in frames.
+static std::vector<uint8_t> record(Effect effect, int numpix, int frames, unsigned int keyinterval, std::vector<Frame> &drawn)
+{
+  fill_solid(leds, numpix, CRGB::Black);
+  NeoPixelEffectsParticles particles;
+  NeoPixelEffects fx(leds, effect, 0, numpix - 1, max(numpix / 8, 1), DELAY, CRGB(255, 120, 9), true, FORWARD);
+#if NEOPIXELEFFECTS_PARTICLES
+  fx.setParticles(&particles);
+#else
+  (void)particles;
+#endif
+
+  std::vector<uint8_t> data;
+  FILE *file = tmpfile();
+  if (file == NULL) {
+    CHECK_MSG(false, "%s", "no temporary file");
+    return data;
+  }
+  NeoPixelEffectsRecorder recorder(leds, numpix);
+  CHECK(recorder.begin(file, DELAY, keyinterval));
+
+  drawn.clear();
+  unsigned long now = 1000;
+  for (int frame = 0; frame < frames; frame++) {
+    if (fx.getStatus() != ACTIVE) {
+      fx.setEffect(effect);
+    }
+    fx.update(now);
+    now += DELAY;
+    CHECK(recorder.record());
+    drawn.push_back(Frame(leds, leds + numpix));
+  }
+  CHECK(recorder.end());
+  CHECK(recorder.getFrames() == (unsigned long)frames);
+
+  long length = ftell(file);
+  CHECK_MSG(length == (long)recorder.getBytes(), "file has %ld bytes, recorder wrote %lu", length, recorder.getBytes());
+  data.resize(length);
+  rewind(file);
+  CHECK(fread(data.data(), 1, length, file) == (size_t)length);
+  fclose(file);
+  return data;
+}
+
+static bool matches(const Frame &frame, int numpix)
+{
+  for (int i = 0; i < numpix; i++) {
+    if (played[i] != frame[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void checkRoundTrip(Effect effect, int numpix)
+{
+  std::vector<Frame> drawn;
+  std::vector<uint8_t> data = record(effect, numpix, FRAMES, NEOPIXELEFFECTS_KEYFRAME_INTERVAL, drawn);
+
+  NeoPixelEffectsPlayer player(played, numpix);
+  fill_solid(played, numpix, CRGB(7, 7, 7));
+  CHECK_MSG(player.begin(data.data(), data.size()), "effect %d, %d pixels: begin", effect, numpix);
+  CHECK(player.getFrameCount() == FRAMES);
+  CHECK(player.getDelay() == DELAY);
+  for (int frame = 0; frame < FRAMES; frame++) {
+    CHECK_MSG(player.nextFrame(), "effect %d, %d pixels: frame %d missing", effect, numpix, frame);
+    CHECK(player.getFrame() == (unsigned long)frame);
+    CHECK_MSG(matches(drawn[frame], numpix), "effect %d, %d pixels: frame %d differs", effect, numpix, frame);
+  }
+  CHECK_MSG(!player.nextFrame(), "effect %d, %d pixels: frame past the end", effect, numpix);
+}
+
+// Seeks forwards and backwards to every frame, keyframes included
+static void checkSeek()
+{
+  const int numpix = 150;
+  const unsigned int keyinterval = 8;
+  const int frames = 53;
+  std::vector<Frame> drawn;
+  std::vector<uint8_t> data = record(RAINBOWWAVE, numpix, frames, keyinterval, drawn);
+
+  NeoPixelEffectsPlayer player(played, numpix);
+  CHECK(player.begin(data.data(), data.size()));
+  for (int frame = frames - 1; frame >= 0; frame--) {
+    CHECK_MSG(player.seek(frame), "seek to %d", frame);
+    CHECK(player.getFrame() == (unsigned long)frame);
+    CHECK_MSG(matches(drawn[frame], numpix), "seek to %d%s", frame, (frame % keyinterval == 0) ? ", a keyframe" : "");
+  }
+  for (int frame = 0; frame < frames; frame += 3) {
+    CHECK_MSG(player.seek(frame) && matches(drawn[frame], numpix), "seek to %d going forward", frame);
+    // Playback carries on from where seek() left it
+    if (frame + 1 < frames) {
+      CHECK_MSG(player.nextFrame() && matches(drawn[frame + 1], numpix), "frame after seeking to %d", frame);
+    }
+  }
+  CHECK(!player.seek(frames));
+}
+
+static void checkRepeat()
+{
+  const int numpix = 40;
+  const int frames = 12;
+  std::vector<Frame> drawn;
+  std::vector<uint8_t> data = record(COMET, numpix, frames, 5, drawn);
+
+  NeoPixelEffectsPlayer player(played, numpix);
+  CHECK(player.begin(data.data(), data.size()));
+  player.setRepeat(true);
+  for (int frame = 0; frame < 3 * frames; frame++) {
+    CHECK_MSG(player.nextFrame(), "repeating frame %d missing", frame);
+    CHECK_MSG(player.getFrame() == (unsigned long)(frame % frames), "repeating frame %d shows %lu", frame, player.getFrame());
+    CHECK_MSG(matches(drawn[frame % frames], numpix), "repeating frame %d differs", frame);
+  }
+
+  // Without repeat playback stops on the last frame
+  player.setRepeat(false);
+  player.seek(frames - 2);
+  CHECK(player.nextFrame());
+  CHECK(!player.nextFrame());
+  CHECK(player.getFrame() == frames - 1);
+  CHECK(matches(drawn[frames - 1], numpix));
+}
+
+static void checkRejected()
+{
+  const int numpix = 30;
+  std::vector<Frame> drawn;
+  std::vector<uint8_t> data = record(SINEWAVE, numpix, 20, 6, drawn);
+
+  NeoPixelEffectsPlayer player(played, numpix);
+  CHECK(player.begin(data.data(), data.size()));
+  CHECK(!player.begin(NULL, data.size()));
+  CHECK(!player.begin(data.data(), 0));
+  CHECK(!player.begin(data.data(), 12));
+  for (size_t cut = 1; cut < data.size(); cut += (cut < 40) ? 1 : 37) {
+    CHECK_MSG(!player.begin(data.data(), data.size() - cut), "recording cut by %d bytes accepted", (int)cut);
+  }
+  CHECK(!player.nextFrame());
+  CHECK(!player.seek(0));
+
+  NeoPixelEffectsPlayer shorter(played, numpix - 1);
+  CHECK(!shorter.begin(data.data(), data.size()));
+  NeoPixelEffectsPlayer longer(played, numpix + 1);
+  CHECK(!longer.begin(data.data(), data.size()));
+
+  std::vector<uint8_t> damaged = data;
+  damaged[0] = 'X';
+  CHECK(!player.begin(damaged.data(), damaged.size()));
+  damaged = data;
+  damaged[4]++;
+  CHECK(!player.begin(damaged.data(), damaged.size()));
+  damaged = data;
+  damaged[damaged.size() - 1] = 'X';
+  CHECK(!player.begin(damaged.data(), damaged.size()));
+}
+
+int main()
+{
+  // TALKING needs six pixels; 64 and up cover the long skip opcode
+  static const int sizes[] = {6, 17, 64, 130, MAX_LEDS};
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      checkRoundTrip((Effect)e, sizes[s]);
+    }
+  }
+  checkSeek();
+  checkRepeat();
+  checkRejected();
+  return testResult();
+}
@@ -0,0 +1,103 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks that render(n) draws the frame an effect shows after stepping
+// through ticks 0 to n with update(), for every effect render() supports,
+// in both directions, looping and not, and for ticks well past the end
+// of a non-looping effect, where the last frame shown stays on the strip.
+// Effects render() does not support must say so.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+
+#define GUARD     3
+#define MAX_LEDS  60
+#define DELAY     10
+#define TICKS     450
+
+static CRGB leds[MAX_LEDS + 2 * GUARD];
+static CRGB rendered[MAX_LEDS + 2 * GUARD];
+static const CRGB guard(1, 2, 3);
+
+static bool supported(Effect effect)
+{
+  switch (effect) {
+    case COMET:
+    case LARSON:
+    case CHASE:
+    case PULSE:
+    case GLOW:
+    case RAINBOWWAVE:
+    case STROBE:
+    case SINEWAVE:
+    case TRIWAVE:
+    case FILLIN:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void checkEffect(Effect effect, int numpix, bool repeat, bool direction)
+{
+  int last = GUARD + numpix - 1;
+  int aoe = max(numpix / 6, 1);
+  CRGB color(200, 90, 255);
+  // Stepped effects such as COMET draw over the last frame, starting from
+  // a clear strip
+  fill_solid(leds, numpix + 2 * GUARD, guard);
+  fill_solid(leds + GUARD, numpix, CRGB::Black);
+  NeoPixelEffects stepped(leds, effect, GUARD, last, aoe, DELAY, color, repeat, direction);
+  NeoPixelEffects direct(rendered, effect, GUARD, last, aoe, DELAY, color, repeat, direction);
+
+  unsigned long now = 1000;
+  for (unsigned long tick = 0; tick < TICKS; tick++) {
+    stepped.update(now);
+    now += DELAY;
+
+    // Whatever was drawn before, render() draws the whole range
+    fill_solid(rendered, numpix + 2 * GUARD, CRGB(tick, 0, 77));
+    CHECK_MSG(direct.render(tick), "effect %d: render(%lu) not supported", effect, tick);
+    bool same = memcmp(leds + GUARD, rendered + GUARD, numpix * sizeof(CRGB)) == 0;
+    CHECK_MSG(same, "effect %d, %d pixels, %s, %s: render(%lu) differs from update()", effect, numpix,
+      repeat ? "looping" : "once", direction == FORWARD ? "forward" : "reverse", tick);
+  }
+
+  for (int i = 0; i < GUARD; i++) {
+    CHECK(rendered[i] == CRGB((uint8_t)(TICKS - 1), 0, 77));
+    CHECK(leds[i] == guard && leds[last + 1 + i] == guard);
+  }
+}
+
+int main()
+{
+  static const int sizes[] = {6, 17, MAX_LEDS};
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    Effect effect = (Effect)e;
+    if (!supported(effect)) {
+      fill_solid(leds, MAX_LEDS, guard);
+      NeoPixelEffects fx(leds, effect, 0, MAX_LEDS - 1, 1, DELAY, CRGB::Red, true, FORWARD);
+      CHECK_MSG(!fx.render(5), "effect %d: render() claims support", effect);
+      continue;
+    }
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      for (int repeat = 0; repeat <= 1; repeat++) {
+        checkEffect(effect, sizes[s], repeat, FORWARD);
+        checkEffect(effect, sizes[s], repeat, REVERSE);
+      }
+    }
+  }
+  return testResult();
+}
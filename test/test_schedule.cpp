@@ -0,0 +1,156 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks getNextUpdate() on a simulated clock. One copy of a set of
+// effects is updated every millisecond; a second copy sleeps until the
+// time the manager reports and is only updated then. Both must render the
+// same frames at the same times: a frame the sleeper renders later than
+// the busy copy was missed, and update() must never render before the
+// reported time. Effects are paused and resumed on the way, and TALKING
+// rests between syllables.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsManager.h>
+
+#define NUM_LEDS    120
+#define NUM_EFFECTS 10
+#define RUN_MS      3000
+#define PAUSE_AT    700
+#define PLAY_AT     1100
+
+struct Copy {
+  CRGB leds[NUM_LEDS];
+  NeoPixelEffects effects[NUM_EFFECTS];
+  NeoPixelEffectsManager manager;
+};
+
+static Copy busy, sleeper;
+
+static void setUp(Copy &copy, int variant)
+{
+  static const Effect kinds[NUM_EFFECTS] = {COMET, CHASE, PULSE, TALKING, TALKING, FADE, FILLIN, GLOW, STATIC, SINEWAVE};
+  static const unsigned long delays[4][NUM_EFFECTS] = {
+    {10, 25, 7, 0, 13, 30, 9, 11, 40, 3},
+    {1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+    {0, 50, 0, 20, 0, 0, 33, 0, 5, 17},
+    {997, 3, 128, 60, 7, 2, 250, 19, 1, 64},
+  };
+
+  fill_solid(copy.leds, NUM_LEDS, CRGB::White);
+  copy.manager.removeAll();
+  for (int i = 0; i < NUM_EFFECTS; i++) {
+    int start = i * (NUM_LEDS / NUM_EFFECTS);
+    copy.effects[i] = NeoPixelEffects(copy.leds, kinds[i], start, start + NUM_LEDS / NUM_EFFECTS - 1, 3,
+                                      delays[variant][i], CRGB(200, 90, 40), i != 7, (i & 1) ? REVERSE : FORWARD);
+    copy.manager.add(&copy.effects[i]);
+  }
+  // Without NEOPIXELEFFECTS_SEEDS this restarts the generator all effects share
+  copy.effects[0].setSeed(1);
+}
+
+// Sketch actions both copies take at the same times
+static void act(Copy &copy, unsigned long now)
+{
+  if (now == PAUSE_AT) {
+    copy.effects[0].pause();
+    copy.effects[3].pause();
+  } else if (now == PLAY_AT) {
+    copy.effects[0].play();
+    copy.effects[3].play();
+  }
+}
+
+// The busy copy runs first and the sleeper is checked against its frames,
+// so the two never draw from a shared generator in turn
+static void run(int variant)
+{
+  static CRGB frames[RUN_MS][NUM_LEDS];
+  static bool rendered[RUN_MS];
+  unsigned long start = 100000UL * (variant + 1);
+
+  setUp(busy, variant);
+  for (unsigned long t = start; t < start + RUN_MS; t++) {
+    act(busy, t - start);
+    rendered[t - start] = busy.manager.update(t);
+    memcpy(frames[t - start], busy.leds, sizeof(busy.leds));
+  }
+
+  setUp(sleeper, variant);
+  unsigned long wake = start;
+  bool scheduled = true;
+  for (unsigned long t = start; t < start + RUN_MS; t++) {
+    unsigned long elapsed = t - start;
+
+    // The sleeper also wakes for the sketch's own actions
+    bool event = (elapsed == PAUSE_AT || elapsed == PLAY_AT);
+    bool sleeper_rendered = false;
+    if (event || (scheduled && t >= wake)) {
+      act(sleeper, elapsed);
+      sleeper_rendered = sleeper.manager.update(t);
+      CHECK_MSG(!scheduled || t >= wake || !sleeper_rendered, "variant %d: frame at %lu before the reported %lu", variant, elapsed, wake - start);
+
+      // Nothing can happen before the next millisecond
+      scheduled = sleeper.manager.getNextUpdate(wake, t);
+      if (scheduled && wake <= t) {
+        wake = t + 1;
+      }
+    }
+
+    CHECK_MSG(rendered[elapsed] == sleeper_rendered, "variant %d at %lu ms: busy copy %s, sleeping copy %s", variant, elapsed,
+              rendered[elapsed] ? "rendered" : "idle", sleeper_rendered ? "rendered" : "idle");
+    CHECK_MSG(memcmp(frames[elapsed], sleeper.leds, sizeof(sleeper.leds)) == 0, "variant %d at %lu ms: pixels differ", variant, elapsed);
+  }
+}
+
+// A single effect is never due early and always due at the reported time
+static void checkEffect(Effect effect, unsigned long delay)
+{
+  CRGB leds[30];
+  NeoPixelEffects fx(leds, effect, 0, 29, 3, delay, CRGB::Red, true, FORWARD);
+  unsigned long now = 5000;
+  fx.update(now);
+  for (int frame = 0; frame < 200; frame++) {
+    unsigned long when;
+    if (!fx.getNextUpdate(when, now)) {
+      CHECK_MSG(fx.getStatus() != ACTIVE, "effect %d: active but nothing scheduled", effect);
+      break;
+    }
+    for (unsigned long t = now + 1; t < when; t++) {
+      CHECK_MSG(!fx.update(t), "effect %d, delay %lu: frame at %lu, reported %lu", effect, delay, t, when);
+    }
+    now = (when > now) ? when : now + 1;
+    CHECK_MSG(fx.update(now) || fx.getStatus() != ACTIVE, "effect %d, delay %lu: no frame at the reported %lu", effect, delay, now);
+  }
+
+  // Paused effects report nothing
+  fx.pause();
+  unsigned long when;
+  CHECK(!fx.getNextUpdate(when, now));
+}
+
+int main()
+{
+  for (int variant = 0; variant < 4; variant++) {
+    run(variant);
+  }
+  static const unsigned long delays[] = {0, 1, 10, 33};
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    for (unsigned int d = 0; d < sizeof(delays) / sizeof(delays[0]); d++) {
+      checkEffect((Effect)e, delays[d]);
+    }
+  }
+  return testResult();
+}
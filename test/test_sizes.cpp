@@ -0,0 +1,55 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Prints the options this build of the library was made with and the
+// size of an effect and of the objects sketches keep next to it, so
+// builds can be compared with ctest -V. A compact build with its default
+// options must stay within the size the README gives for it.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsCorrection.h>
+#include <NeoPixelEffectsManager.h>
+#include <NeoPixelEffectsParticles.h>
+#include <NeoPixelEffectsPool.h>
+
+#define PRINT_OPTION(name) printf("%-28s %d\n", #name, name)
+#define PRINT_SIZE(type) printf("sizeof(%s)%*s %u\n", #type, (int)(26 - sizeof(#type)), "", (unsigned int)sizeof(type))
+
+int main()
+{
+  PRINT_OPTION(NEOPIXELEFFECTS_COMPACT);
+  PRINT_OPTION(NEOPIXELEFFECTS_FIXED_POINT);
+  PRINT_OPTION(NEOPIXELEFFECTS_CACHE);
+  PRINT_OPTION(NEOPIXELEFFECTS_PARTICLES);
+  PRINT_OPTION(NEOPIXELEFFECTS_SEEDS);
+  PRINT_OPTION(NEOPIXELEFFECTS_DIRTY);
+  PRINT_OPTION(NEOPIXELEFFECTS_STATS);
+  PRINT_OPTION(NEOPIXELEFFECTS_POWER);
+  PRINT_SIZE(NeoPixelEffects);
+  PRINT_SIZE(NeoPixelEffectsManager);
+  PRINT_SIZE(NeoPixelEffectsPool);
+  PRINT_SIZE(NeoPixelEffectsParticles);
+  PRINT_SIZE(NeoPixelEffectsCorrection);
+  PRINT_SIZE(NeoPixelEffectsCache);
+
+#if NEOPIXELEFFECTS_COMPACT && !NEOPIXELEFFECTS_CACHE && !NEOPIXELEFFECTS_STATS && !NEOPIXELEFFECTS_POWER
+  // 44 bytes on AVR, 48 on 32-bit boards and 56 on 64-bit hosts
+  unsigned int budget = (sizeof(CRGB *) == 2) ? 44 : (sizeof(CRGB *) == 4) ? 48 : 56;
+  CHECK_MSG(sizeof(NeoPixelEffects) <= budget, "compact effect takes %u bytes, budget %u",
+    (unsigned int)sizeof(NeoPixelEffects), budget);
+#endif
+  return testResult();
+}
@@ -0,0 +1,147 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Checks the counters kept with NEOPIXELEFFECTS_STATS on a simulated
+// clock: calls, frames, late frames, missed ticks and jitter for a
+// scripted series of on-time, early and late calls, with both timing
+// policies, and the manager's total, reset and CSV table.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsManager.h>
+#include <string>
+
+#if !NEOPIXELEFFECTS_STATS
+  #error "Build with NEOPIXELEFFECTS_STATS=1"
+#endif
+
+#define NUM_LEDS  60
+#define DELAY     10
+
+static CRGB leds[NUM_LEDS];
+
+class StringPrint : public Print {
+  public:
+    size_t write(uint8_t c)
+    {
+      text += (char)c;
+      return 1;
+    }
+
+    std::string text;
+};
+
+struct Call {
+  unsigned long now;
+  bool rendered;
+};
+
+// A frame on time, early calls, a frame 3 ms late, one 7 ms late after
+// two missed ticks and one 2 ms late after four
+static const Call calls[] = {
+  {1000, true}, {1005, false}, {1010, true}, {1013, false}, {1023, true},
+  {1029, false}, {1057, true}, {1060, true}, {1112, true}, {1115, false},
+};
+
+static void checkCounts(TimingPolicy policy)
+{
+  NeoPixelEffects fx(leds, RAINBOWWAVE, 0, NUM_LEDS - 1, 1, DELAY, CRGB::Red, true, FORWARD);
+  fx.setTimingPolicy(policy);
+  const NeoPixelEffectsStats &stats = fx.getStats();
+  CHECK(stats.calls == 0 && stats.frames == 0);
+
+  for (unsigned int i = 0; i < sizeof(calls) / sizeof(calls[0]); i++) {
+    CHECK_MSG(fx.update(calls[i].now) == calls[i].rendered, "policy %d: call at %lu", policy, calls[i].now);
+  }
+  CHECK_MSG(stats.calls == 10, "policy %d: %lu calls", policy, stats.calls);
+  CHECK_MSG(stats.frames == 6, "policy %d: %lu frames", policy, stats.frames);
+  CHECK_MSG(stats.late == 2, "policy %d: %lu late frames", policy, stats.late);
+  CHECK_MSG(stats.missed == 6, "policy %d: %lu missed ticks", policy, stats.missed);
+  CHECK(fx.getLateFrames() == 6);
+  CHECK_MSG(stats.totaljitter == 12, "policy %d: %lu ms jitter", policy, stats.totaljitter);
+  CHECK_MSG(stats.maxjitter == 7, "policy %d: %lu ms max jitter", policy, stats.maxjitter);
+  CHECK(stats.getMeanJitter() == 2);
+  CHECK(stats.maxtime <= stats.totaltime);
+  CHECK(stats.getMeanTime() <= stats.maxtime);
+
+  // A paused effect still counts its calls
+  fx.pause();
+  CHECK(!fx.update(1200));
+  CHECK(stats.calls == 11 && stats.frames == 6);
+
+  fx.resetStats();
+  CHECK(stats.calls == 0 && stats.frames == 0 && stats.late == 0 && stats.missed == 0);
+  CHECK(stats.totaltime == 0 && stats.maxtime == 0 && stats.totaljitter == 0 && stats.maxjitter == 0);
+}
+
+static int countLines(const std::string &text)
+{
+  int lines = 0;
+  for (size_t i = 0; i < text.size(); i++) {
+    if (text[i] == '\n') {
+      lines++;
+    }
+  }
+  return lines;
+}
+
+// update() without a time reads millis(), which setMillis() controls
+static void checkManager()
+{
+  NeoPixelEffects effects[3];
+  effects[0] = NeoPixelEffects(leds, RAINBOWWAVE, 0, 19, 1, DELAY, CRGB::Red, true, FORWARD);
+  effects[1] = NeoPixelEffects(leds, COMET, 20, 39, 4, 2 * DELAY, CRGB::Cyan, true, FORWARD);
+  effects[2] = NeoPixelEffects(leds, PULSE, 40, 59, 1, 3 * DELAY, CRGB::Green, true, FORWARD);
+  NeoPixelEffectsManager manager;
+  manager.add(effects, 3);
+
+  // Every effect renders at 0 and then every 10, 20 or 30 ms up to 120
+  for (unsigned long now = 0; now <= 120; now += DELAY) {
+    setMillis(5000 + now);
+    manager.update();
+  }
+  // Then one call 55 ms on, 5, 15 and 25 ms after the last tick due and
+  // after missing 4, 1 and no ticks
+  setMillis(5175);
+  manager.update();
+
+  NeoPixelEffectsStats total;
+  manager.getStats(total);
+  CHECK_MSG(total.calls == 3 * 14, "manager: %lu calls", total.calls);
+  CHECK_MSG(total.frames == 14 + 8 + 6, "manager: %lu frames", total.frames);
+  CHECK_MSG(total.late == 2, "manager: %lu late frames", total.late);
+  CHECK_MSG(total.missed == 4 + 1, "manager: %lu missed ticks", total.missed);
+  CHECK(manager.getLateFrames() == 5);
+  CHECK_MSG(total.totaljitter == 5 + 15 + 25, "manager: %lu ms jitter", total.totaljitter);
+  CHECK(total.maxjitter == 25);
+
+  StringPrint out;
+  manager.printStats(out);
+  // A header, a row per effect and the total
+  CHECK_MSG(countLines(out.text) == 5, "manager: %d lines printed", countLines(out.text));
+  CHECK(out.text.find("\ntotal,,,42,28,2,5,") != std::string::npos);
+
+  manager.resetStats();
+  manager.getStats(total);
+  CHECK(total.calls == 0 && total.frames == 0 && total.missed == 0 && total.totaljitter == 0);
+}
+
+int main()
+{
+  checkCounts(TIMING_SKIP);
+  checkCounts(TIMING_CATCHUP);
+  checkManager();
+  return testResult();
+}
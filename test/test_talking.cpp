@@ -0,0 +1,87 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Runs 64 TALKING effects side by side, each with its own seed, and checks
+// every one draws exactly what it draws when it runs on its own. Shared
+// state between instances would make the interleaved run differ.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+
+#define NUM_TALKING 64
+#define SEGMENT_LEN 12
+#define NUM_LEDS    (NUM_TALKING * SEGMENT_LEN)
+#define RUN_MS      5000
+
+static CRGB together[RUN_MS][NUM_LEDS];
+static CRGB alone[NUM_LEDS];
+
+static void start(NeoPixelEffects &fx, CRGB *leds, int i)
+{
+  fx = NeoPixelEffects(leds, TALKING, i * SEGMENT_LEN, (i + 1) * SEGMENT_LEN - 1, 3, 5 + i % 4, CRGB::Red, true, FORWARD);
+  fx.setSeed(1000 + i);
+}
+
+int main()
+{
+  static NeoPixelEffects effects[NUM_TALKING];
+  static CRGB leds[NUM_LEDS];
+  for (int i = 0; i < NUM_TALKING; i++) {
+    start(effects[i], leds, i);
+  }
+  for (unsigned long t = 0; t < RUN_MS; t++) {
+    for (int i = 0; i < NUM_TALKING; i++) {
+      effects[i].update(t + 1);
+    }
+    memcpy(together[t], leds, sizeof(leds));
+  }
+
+  // Each instance replayed on its own must match its segment of every frame
+  for (int i = 0; i < NUM_TALKING; i++) {
+    NeoPixelEffects fx;
+    fill_solid(alone, NUM_LEDS, CRGB::Black);
+    start(fx, alone, i);
+    bool same = true;
+    for (unsigned long t = 0; t < RUN_MS && same; t++) {
+      fx.update(t + 1);
+      same = memcmp(together[t] + i * SEGMENT_LEN, alone + i * SEGMENT_LEN, SEGMENT_LEN * sizeof(CRGB)) == 0;
+      CHECK_MSG(same, "instance %d differs at %lu ms when run alone", i, t + 1);
+    }
+  }
+
+  // Different seeds must not talk in step
+  bool moved[NUM_TALKING] = {false};
+  for (unsigned long t = 1; t < RUN_MS; t++) {
+    for (int i = 0; i < NUM_TALKING; i++) {
+      if (memcmp(together[t] + i * SEGMENT_LEN, together[t - 1] + i * SEGMENT_LEN, SEGMENT_LEN * sizeof(CRGB)) != 0) {
+        moved[i] = true;
+      }
+    }
+  }
+  for (int i = 0; i < NUM_TALKING; i++) {
+    CHECK_MSG(moved[i], "instance %d never moved", i);
+  }
+  int differing = 0;
+  for (int i = 1; i < NUM_TALKING; i++) {
+    for (unsigned long t = 0; t < RUN_MS; t++) {
+      if (memcmp(together[t] + i * SEGMENT_LEN, together[t], SEGMENT_LEN * sizeof(CRGB)) != 0) {
+        differing++;
+        break;
+      }
+    }
+  }
+  CHECK_MSG(differing == NUM_TALKING - 1, "only %d of %d instances differ from the first", differing, NUM_TALKING - 1);
+  return testResult();
+}
@@ -0,0 +1,212 @@
+/*--------------------------------------------------------------------
+  This file is part of the NeoPixel Effects library.
+  NeoPixel is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of
+  the License, or (at your option) any later version.
+  NeoPixel is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+  You should have received a copy of the GNU Lesser General Public
+  License along with NeoPixel.  If not, see
+  <http://www.gnu.org/licenses/>.
+  --------------------------------------------------------------------*/
+
+// Drives every effect through update() on a simulated clock over strip
+// sizes from 16 to 10,000 pixels. Checks that frames come exactly when
+// due, also across 2^32 ms, that nothing outside the range or the
+// reported dirty span is written, that SPARKLEFILL keeps its sparks in the
+// filled part, that update() reading millis() behaves as update(now) and
+// that NeoPixelEffectsCompiled draws the same frames as the effect it
+// fixes.
+
+#include "test.h"
+#include <NeoPixelEffects.h>
+#include <NeoPixelEffectsCompiled.h>
+#include <NeoPixelEffectsParticles.h>
+
+#define GUARD     4
+#define MAX_LEDS  10000
+#define DELAY     10
+#define FRAMES    60
+
+static CRGB leds[MAX_LEDS + 2 * GUARD];
+static CRGB other[MAX_LEDS + 2 * GUARD];
+static const CRGB guard(1, 2, 3);
+
+static bool alwaysRenders(Effect effect)
+{
+  // TALKING rests between syllables, FADE and FILLIN pause when done
+  return effect != TALKING && effect != FADE && effect != FILLIN;
+}
+
+static void runEffect(Effect effect, int numpix)
+{
+  fill_solid(leds, numpix + 2 * GUARD, guard);
+  NeoPixelEffectsParticles particles;
+  NeoPixelEffects fx(leds, effect, GUARD, GUARD + numpix - 1, max(numpix / 8, 1), DELAY, CRGB::Cyan, true, FORWARD);
+#if NEOPIXELEFFECTS_PARTICLES
+  fx.setParticles(&particles);
+#else
+  (void)particles;
+#endif
+
+  unsigned long now = 1000;
+  CHECK_MSG(fx.update(now), "effect %d, %d pixels: first call renders", effect, numpix);
+  for (int frame = 1; frame < FRAMES; frame++) {
+    CHECK_MSG(!fx.update(now + DELAY - 1), "effect %d, %d pixels: frame %d early", effect, numpix, frame);
+    now += DELAY;
+    memcpy(other, leds, (numpix + 2 * GUARD) * sizeof(CRGB));
+    fx.clearDirty();
+    bool rendered = fx.update(now);
+    if (alwaysRenders(effect)) {
+      CHECK_MSG(rendered, "effect %d, %d pixels: frame %d missing", effect, numpix, frame);
+    }
+
+    // Every pixel the frame changed must be inside the reported span
+    int first = numpix + 2 * GUARD;
+    int last = -1;
+    fx.getDirtyRange(first, last);
+    for (int i = 0; i < numpix + 2 * GUARD; i++) {
+      if (i < first || i > last) {
+        CHECK_MSG(leds[i] == other[i], "effect %d, %d pixels: frame %d changed pixel %d outside its dirty range", effect, numpix, frame, i);
+      }
+    }
+  }
+
+  for (int i = 0; i < GUARD; i++) {
+    CHECK_MSG(leds[i] == guard, "effect %d, %d pixels: pixel %d before the range written", effect, numpix, i);
+    CHECK_MSG(leds[GUARD + numpix + i] == guard, "effect %d, %d pixels: pixel %d after the range written", effect, numpix, i);
+  }
+}
+
+// Frames keep coming exactly when due across 2^32 ms, where millis()
+// wraps on the boards and compact builds wrap their clock on any host
+static void checkClockWrap(Effect effect)
+{
+  fill_solid(leds, 60, CRGB::Black);
+  NeoPixelEffects fx(leds, effect, 0, 59, 4, DELAY, CRGB::Red, true, FORWARD);
+  unsigned long now = 0xFFFFFFFFUL - 5 * DELAY;
+  CHECK_MSG(fx.update(now), "effect %d: first call before the wrap renders", effect);
+  for (int frame = 1; frame < 20; frame++) {
+    CHECK_MSG(!fx.update(now + DELAY - 1), "effect %d: frame %d early across the wrap", effect, frame);
+    now += DELAY;
+    CHECK_MSG(fx.update(now), "effect %d: frame %d missing across the wrap", effect, frame);
+  }
+  CHECK_MSG(fx.getLateFrames() == 0, "effect %d: %lu late frames across the wrap", effect, (unsigned long)fx.getLateFrames());
+}
+
+// SPARKLEFILL lights sparks all over the part already filled and nowhere
+// else, also once the filled part is past 256 pixels
+static void checkSparkleFill()
+{
+#if NEOPIXELEFFECTS_PARTICLES
+  NeoPixelEffectsParticles particles;
+  fill_solid(leds, 2000, CRGB::Black);
+  NeoPixelEffects fx(leds, SPARKLEFILL, 0, 1999, 8, DELAY, CRGB::White, false, FORWARD);
+  fx.setParticles(&particles);
+  int farthest = 0;
+  for (int frame = 0; frame < 1000; frame++) {
+    fx.update(1000 + frame * DELAY);
+    // Sparks sit across two pixels, so one past the filled part may be lit
+    for (int i = 0; i < 2000; i++) {
+      if (leds[i]) {
+        CHECK_MSG(i <= frame + 1, "sparkle fill frame %d: pixel %d lit before it filled", frame, i);
+        farthest = max(farthest, i);
+      }
+    }
+  }
+  CHECK_MSG(farthest >= 900, "sparkle fill: no spark past pixel %d of 1000 filled", farthest);
+#endif
+}
+
+// The paired checks below run one copy to the end and then the other, since
+// without NEOPIXELEFFECTS_SEEDS every effect draws from one generator
+#define PAIRED_PIXELS 60
+#define PAIRED_CALLS  200
+static CRGB recorded[PAIRED_CALLS][PAIRED_PIXELS];
+static bool recorded_rendered[PAIRED_CALLS];
+
+// The same effect driven through update() and millis() draws the same
+// frames as through update(now)
+static void checkMillis(Effect effect)
+{
+  fill_solid(other, PAIRED_PIXELS, CRGB::Black);
+  NeoPixelEffects clocked(other, effect, 0, PAIRED_PIXELS - 1, 6, DELAY, CRGB::Red, true, FORWARD);
+  clocked.setSeed(1);
+  for (int i = 0; i < PAIRED_CALLS; i++) {
+    setMillis(5000 + i * 3);
+    recorded_rendered[i] = clocked.update();
+    memcpy(recorded[i], other, sizeof(recorded[i]));
+  }
+
+  fill_solid(leds, PAIRED_PIXELS, CRGB::Black);
+  NeoPixelEffects injected(leds, effect, 0, PAIRED_PIXELS - 1, 6, DELAY, CRGB::Red, true, FORWARD);
+  injected.setSeed(1);
+  for (int i = 0; i < PAIRED_CALLS; i++) {
+    unsigned long now = 5000 + i * 3;
+    CHECK_MSG(injected.update(now) == recorded_rendered[i], "effect %d at %lu ms", effect, now);
+    CHECK_MSG(memcmp(leds, recorded[i], sizeof(recorded[i])) == 0, "effect %d at %lu ms: pixels differ", effect, now);
+  }
+}
+
+// Late calls with catch-up on, so replayed ticks go through the compiled
+// step as well
+template <class T>
+static unsigned int runLate(T &fx, bool record)
+{
+  fx.setTimingPolicy(TIMING_CATCHUP);
+  fx.setSeed(1);
+  unsigned long now = 7000;
+  for (int i = 0; i < PAIRED_CALLS; i++) {
+    now += (i % 17 == 0) ? 5 * DELAY + 3 : 4;
+    if (i == 100) {
+      fx.setDelayHz(40);
+    }
+    bool rendered = fx.update(now);
+    if (record) {
+      recorded_rendered[i] = rendered;
+      memcpy(recorded[i], leds, sizeof(recorded[i]));
+    } else {
+      CHECK_MSG(rendered == recorded_rendered[i], "compiled effect %d at %lu ms", fx.getEffect(), now);
+      CHECK_MSG(memcmp(leds, recorded[i], sizeof(recorded[i])) == 0, "compiled effect %d at %lu ms: pixels differ", fx.getEffect(), now);
+    }
+  }
+  return fx.getLateFrames();
+}
+
+template <Effect E>
+static void checkCompiled()
+{
+  fill_solid(leds, PAIRED_PIXELS, CRGB::Black);
+  NeoPixelEffects dynamic(leds, E, 0, PAIRED_PIXELS - 1, 6, DELAY, CRGB::Red, true, FORWARD);
+  unsigned int late = runLate(dynamic, true);
+
+  fill_solid(leds, PAIRED_PIXELS, CRGB::Black);
+  NeoPixelEffectsCompiled<E> compiled(leds, 0, PAIRED_PIXELS - 1, 6, DELAY, CRGB::Red, true, FORWARD);
+  CHECK(runLate(compiled, false) == late);
+}
+
+int main()
+{
+  static const int sizes[] = {16, 64, 256, 1024, 4096, 10000};
+  for (int e = COMET; e < NUM_EFFECT; e++) {
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      runEffect((Effect)e, sizes[s]);
+    }
+    checkMillis((Effect)e);
+    if (alwaysRenders((Effect)e)) {
+      checkClockWrap((Effect)e);
+    }
+  }
+  checkSparkleFill();
+  checkCompiled<COMET>();
+  checkCompiled<CHASE>();
+  checkCompiled<STATIC>();
+  checkCompiled<RANDOM>();
+  checkCompiled<FADE>();
+  checkCompiled<RAINBOWWAVE>();
+  checkCompiled<TALKING>();
+  return testResult();
+}